@@ -1,2 +1,12 @@
 get_filename_component(SELF_DIR "${CMAKE_CURRENT_LIST_FILE}" DIRECTORY)
-include(${SELF_DIR}/RaychelLogger.cmake)
\ No newline at end of file
+
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+
+include(${SELF_DIR}/RaychelLogger.cmake)
+
+#a static library hands its private dependencies on to the programs linking it
+get_target_property(RAYCHELLOGGER_LINK_LIBRARIES RaychelLogger INTERFACE_LINK_LIBRARIES)
+if("${RAYCHELLOGGER_LINK_LIBRARIES}" MATCHES "ZLIB::ZLIB")
+    find_dependency(ZLIB)
+endif()
\ No newline at end of file
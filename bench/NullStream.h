@@ -0,0 +1,29 @@
+#ifndef RAYCHELLOGGER_BENCH_NULLSTREAM_H_
+#define RAYCHELLOGGER_BENCH_NULLSTREAM_H_
+
+#include <ostream>
+#include <streambuf>
+
+/// \brief Stream buffer that throws everything away, so only the cost of getting a record to the output is measured
+class NullBuffer : public std::streambuf
+{
+protected:
+    int_type overflow(int_type ch) override
+    {
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char_type* /*unused*/, std::streamsize count) override
+    {
+        return count;
+    }
+};
+
+inline std::ostream& nullStream()
+{
+    static NullBuffer buffer;
+    static std::ostream stream{&buffer};
+    return stream;
+}
+
+#endif /* RAYCHELLOGGER_BENCH_NULLSTREAM_H_ */
@@ -0,0 +1,49 @@
+#include "RaychelLogger/Logger.h"
+
+#include <benchmark/benchmark.h>
+
+#include "NullStream.h"
+
+namespace {
+
+    void setUp(const benchmark::State& state, bool async)
+    {
+        if (state.thread_index() == 0) {
+            Logger::setOutStream(nullStream());
+            if (async) {
+                Logger::enableAsync(8192, Logger::OverflowPolicy::block);
+            }
+        }
+    }
+
+    void tearDown(const benchmark::State& state, bool async)
+    {
+        if (state.thread_index() == 0 && async) {
+            Logger::disableAsync();
+        }
+    }
+
+    //every record goes through the formatting lock and is written on the calling thread
+    void BM_ContentionMutex(benchmark::State& state)
+    {
+        setUp(state, false);
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("contention record ", 42, ' ', 3.5, '\n');
+        }
+        tearDown(state, false);
+    }
+
+    //records are pushed into the lock-free ring and written by the writer thread
+    void BM_ContentionRing(benchmark::State& state)
+    {
+        setUp(state, true);
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("contention record ", 42, ' ', 3.5, '\n');
+        }
+        tearDown(state, true);
+    }
+
+} // namespace
+
+BENCHMARK(BM_ContentionMutex)->Threads(1)->Threads(4)->Threads(16)->Threads(64)->UseRealTime();
+BENCHMARK(BM_ContentionRing)->Threads(1)->Threads(4)->Threads(16)->Threads(64)->UseRealTime();
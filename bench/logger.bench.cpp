@@ -0,0 +1,174 @@
+#include "RaychelLogger/Logger.h"
+
+#include <benchmark/benchmark.h>
+
+#include "NullStream.h"
+
+#include <fstream>
+
+namespace {
+
+    struct Streamable
+    {
+        int x;
+        int y;
+    };
+
+    std::ostream& operator<<(std::ostream& os, const Streamable& obj)
+    {
+        return os << '(' << obj.x << ", " << obj.y << ')';
+    }
+
+    struct NonStreamable
+    {
+        int x;
+        int y;
+    };
+
+    void BM_FilteredOut(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        Logger::setMinimumLogLevel(Logger::LogLevel::warn);
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::debug("filtered record ", 42, '\n');
+        }
+        Logger::setMinimumLogLevel(Logger::LogLevel::info);
+    }
+    BENCHMARK(BM_FilteredOut);
+
+    void BM_FilteredOutMacro(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        Logger::setMinimumLogLevel(Logger::LogLevel::warn);
+        for ([[maybe_unused]] auto _ : state) {
+            RAYCHELLOGGER_DEBUG("filtered record ", 42, '\n');
+        }
+        Logger::setMinimumLogLevel(Logger::LogLevel::info);
+    }
+    BENCHMARK(BM_FilteredOutMacro);
+
+    void BM_SampledOutMacro(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        Logger::setMinimumLogLevel(Logger::LogLevel::debug);
+        Logger::setSampleRate(Logger::LogLevel::debug, 1000);
+        for ([[maybe_unused]] auto _ : state) {
+            RAYCHELLOGGER_DEBUG("sampled record ", 42, '\n');
+        }
+        Logger::setSampleRate(Logger::LogLevel::debug, 1);
+        Logger::setMinimumLogLevel(Logger::LogLevel::info);
+    }
+    BENCHMARK(BM_SampledOutMacro);
+
+    void BM_InfoSingleArg(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("single argument record\n");
+        }
+    }
+    BENCHMARK(BM_InfoSingleArg);
+
+    void BM_InfoMultiArg(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("int ", 42, " double ", 3.14159, " bool ", true, " char ", 'c', '\n');
+        }
+    }
+    BENCHMARK(BM_InfoMultiArg);
+
+    void BM_InfoFormatString(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info(RAYCHELLOGGER_FMT("int {} double {} bool {} char {}\n"), 42, 3.14159, true, 'c');
+        }
+    }
+    BENCHMARK(BM_InfoFormatString);
+
+    void BM_Streamable(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        const Streamable obj{1, 2};
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("object ", obj, '\n');
+        }
+    }
+    BENCHMARK(BM_Streamable);
+
+    void BM_NonStreamable(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        const NonStreamable obj{1, 2};
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("object ", obj, '\n');
+        }
+    }
+    BENCHMARK(BM_NonStreamable);
+
+    void BM_ColorOn(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        Logger::enableColor();
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("colored record ", 42, '\n');
+        }
+    }
+    BENCHMARK(BM_ColorOn);
+
+    void BM_ColorOff(benchmark::State& state)
+    {
+        Logger::setOutStream(nullStream());
+        Logger::disableColor();
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("plain record ", 42, '\n');
+        }
+        Logger::enableColor();
+    }
+    BENCHMARK(BM_ColorOff);
+
+    void BM_FileSink(benchmark::State& state)
+    {
+        Logger::initLogFile("bench_logs", "Bench.log");
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("file record ", 42, '\n');
+        }
+        Logger::dumpLogFile();
+        Logger::enableColor();
+    }
+    BENCHMARK(BM_FileSink);
+
+    void BM_DevNull(benchmark::State& state)
+    {
+        std::ofstream dev_null{"/dev/null"};
+        Logger::setOutStream(dev_null);
+        Logger::disableColor();
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::info("file record ", 42, '\n');
+        }
+        Logger::flush();
+        Logger::setOutStream(nullStream());
+        Logger::enableColor();
+    }
+    BENCHMARK(BM_DevNull);
+
+    void BM_TimerHandle(benchmark::State& state)
+    {
+        for ([[maybe_unused]] auto _ : state) {
+            const auto timer = Logger::startTimer();
+            benchmark::DoNotOptimize(Logger::endTimer(timer));
+        }
+    }
+    BENCHMARK(BM_TimerHandle);
+
+    void BM_TimerLabeled(benchmark::State& state)
+    {
+        for ([[maybe_unused]] auto _ : state) {
+            Logger::startTimer("bench timer");
+            benchmark::DoNotOptimize(Logger::endTimer("bench timer"));
+        }
+    }
+    BENCHMARK(BM_TimerLabeled);
+
+} // namespace
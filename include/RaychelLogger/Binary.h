@@ -0,0 +1,279 @@
+/**
+*\file Binary.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Binary logging with deferred formatting
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef BINARY_H_
+#define BINARY_H_
+
+#include "Format.h"
+#include "FormatString.h"
+#include "Helper.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Logger {
+
+    enum class LogLevel : size_t;
+
+    namespace details {
+
+        struct ChannelState;
+
+        /**
+        * \brief Turns the payload of a binary record back into text. Generated once per combination of argument types
+        */
+        using BinaryDecoder = void (*)(std::string& out, const std::byte* payload) noexcept;
+
+        /**
+        * \brief Site ID returned when a site could not be registered
+        */
+        constexpr std::uint32_t invalid_binary_site = 0xFFFF'FFFF;
+
+        /**
+        * \brief Register a new binary log site
+        * 
+        * \param decoder Decoder for the payload of records from that site
+        * \return std::uint32_t ID of the site, or invalid_binary_site if it could not be registered
+        */
+        [[nodiscard]] LOGGER_EXPORT std::uint32_t registerBinarySite(BinaryDecoder decoder) noexcept;
+
+        /**
+        * \brief Check if binary logging is currently enabled
+        */
+        [[nodiscard]] LOGGER_EXPORT bool binaryLoggingEnabled() noexcept;
+
+        /**
+        * \brief Get the buffer binary payloads are encoded into before they are copied into the ring buffer of the calling thread
+        */
+        [[nodiscard]] LOGGER_EXPORT std::string& binaryScratchBuffer() noexcept;
+
+        /**
+        * \brief Copy a binary record into the ring buffer of the calling thread
+        * 
+        * \param site ID returned by registerBinarySite()
+        * \param channel Channel the record is written to
+        * \param level Level of the record
+        * \param with_label If the record should be logged with [LABEL] in front of it
+        * \param payload Encoded arguments
+        * \return false if nothing was written, because binary logging was disabled in the meantime, the payload is larger than
+        * the ring buffer or the caller is the decoder thread. Then the caller formats the record itself. For a large payload,
+        * the records of this thread that are still in the ring are written first, so the order of its records is kept
+        */
+        [[nodiscard]] LOGGER_EXPORT bool
+        writeBinaryRecord(std::uint32_t site, const ChannelState& channel, LogLevel level, bool with_label, std::string_view payload) noexcept;
+
+        template <typename T>
+        void appendRaw(std::string& buffer, const T& value) noexcept
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            buffer.append(reinterpret_cast<const char*>(&value), sizeof(T)); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        }
+
+        template <typename T>
+        [[nodiscard]] T readRaw(const std::byte*& payload) noexcept
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            std::memcpy(&value, payload, sizeof(T));
+            payload += sizeof(T); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            return value;
+        }
+
+        inline void appendBinaryString(std::string& buffer, std::string_view str) noexcept
+        {
+            appendRaw(buffer, static_cast<std::uint32_t>(str.size()));
+            buffer.append(str);
+        }
+
+        [[nodiscard]] inline std::string_view readBinaryString(const std::byte*& payload) noexcept
+        {
+            const auto size = readRaw<std::uint32_t>(payload);
+            const std::string_view str{reinterpret_cast<const char*>(payload), size}; //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            payload += size;                                                            //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            return str;
+        }
+
+        /**
+        * \brief How an argument is stored in a binary record. Mirrors the branches of formatArg()
+        * 
+        * \tparam T Type of the argument as it is passed to logConcurrent
+        */
+        template <typename T>
+        struct BinaryCodec
+        {
+            using type = std::remove_cv_t<std::remove_reference_t<T>>;
+
+            static void encode(std::string& buffer, T&& obj) noexcept
+            {
+                if constexpr (is_format_string_v<type>) {
+                    //the literal text is part of the site
+                } else if constexpr (is_key_value_v<type>) {
+                    appendBinaryString(buffer, obj.key);
+                    BinaryCodec<const decltype(obj.value)&>::encode(buffer, obj.value);
+                } else if constexpr (has_formatter_v<type>) {
+                    //like objects with an operator<<, the object might be gone by the time the record is decoded
+                    auto& text = messageBuffer();
+                    const auto start = text.size();
+                    formatter<type>::format(text, obj);
+                    appendBinaryString(buffer, std::string_view{text}.substr(start));
+                    text.resize(start);
+                } else if constexpr (std::is_arithmetic_v<type>) {
+                    //numbers are copied and only formatted by the decoder
+                    appendRaw<type>(buffer, obj);
+                } else if constexpr (is_c_string_v<std::decay_t<T>>) {
+                    const auto* str = reinterpret_cast<const char*>(obj); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                    appendBinaryString(buffer, str == nullptr ? "(null)" : str);
+                } else if constexpr (std::is_convertible_v<const type&, std::string_view>) {
+                    appendBinaryString(buffer, std::string_view{obj});
+                } else if constexpr (std::is_pointer_v<type> && std::is_object_v<std::remove_pointer_t<type>>) {
+                    appendRaw(buffer, reinterpret_cast<std::uintptr_t>(obj)); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                } else if constexpr (is_to_stream_writable_v<std::ostream, T>) {
+                    //the object might be gone by the time the record is decoded, so this is the one case formatted right away
+                    auto& text = messageBuffer();
+                    const auto start = text.size();
+                    formatArg(text, std::forward<T>(obj));
+                    appendBinaryString(buffer, std::string_view{text}.substr(start));
+                    text.resize(start);
+                } else {
+                    appendRaw(buffer, reinterpret_cast<std::uintptr_t>(std::addressof(obj))); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+                }
+            }
+
+            static void decode(std::string& out, const std::byte*& payload) noexcept
+            {
+                if constexpr (is_key_value_v<type>) {
+                    using value_type = const decltype(std::declval<type>().value)&;
+                    const auto key = readBinaryString(payload);
+                    appendField<value_type>(
+                        key, [&payload](std::string& text) { BinaryCodec<value_type>::decode(text, payload); });
+                } else if constexpr (has_formatter_v<type>) {
+                    out.append(readBinaryString(payload));
+                } else if constexpr (std::is_arithmetic_v<type>) {
+                    formatArg(out, readRaw<type>(payload));
+                } else if constexpr (is_c_string_v<std::decay_t<T>> || std::is_convertible_v<const type&, std::string_view>) {
+                    out.append(readBinaryString(payload));
+                } else if constexpr (std::is_pointer_v<type> && std::is_object_v<std::remove_pointer_t<type>>) {
+                    appendAddress<std::remove_reference_t<T>>(
+                        out,
+                        reinterpret_cast<const volatile void*>(readRaw<std::uintptr_t>(payload))); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+                } else if constexpr (is_to_stream_writable_v<std::ostream, T>) {
+                    out.append(readBinaryString(payload));
+                } else {
+                    appendAddress<std::remove_reference_t<T>>(
+                        out,
+                        reinterpret_cast<const volatile void*>(readRaw<std::uintptr_t>(payload))); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast, performance-no-int-to-ptr)
+                }
+            }
+        };
+
+        /**
+        * \brief Decode the arguments of a record that was logged with a format string and put them into its slots
+        */
+        template <typename Format, typename... Args, std::size_t... I>
+        void decodeFormatted(std::string& out, const std::byte* payload, std::index_sequence<I...> /*unused*/) noexcept
+        {
+            using arg_types = std::tuple<Args...>;
+            constexpr auto slots = Format::slots;
+
+            appendSegments<Format>(
+                out,
+                [&payload](std::string& text, auto index) {
+                    BinaryCodec<std::tuple_element_t<decltype(index)::value, arg_types>>::decode(text, payload);
+                },
+                std::make_index_sequence<slots>{});
+
+            //I covers every argument, the ones for the slots are already decoded
+            ((I >= slots ? BinaryCodec<std::tuple_element_t<I, arg_types>>::decode(out, payload) : void()), ...);
+        }
+
+        template <typename Format, typename... Args>
+        void decodeFormattedRecord(std::string& out, const std::byte* payload) noexcept
+        {
+            decodeFormatted<std::remove_cv_t<std::remove_reference_t<Format>>, Args...>(out, payload, std::index_sequence_for<Args...>{});
+        }
+
+        template <typename... Args>
+        void decodeBinary(std::string& out, const std::byte* payload) noexcept
+        {
+            if constexpr (starts_with_format_v<Args...>) {
+                decodeFormattedRecord<Args...>(out, payload);
+            } else {
+                (BinaryCodec<Args>::decode(out, payload), ...);
+            }
+        }
+
+        /**
+        * \brief Get the site ID for a combination of argument types. Literal text is part of the payload, so every call with
+        * the same argument types can share one site. Calls with a format string have a type of their own and keep the literal
+        * text in the site. Returns invalid_binary_site if registration failed; the next call tries again
+        */
+        template <typename... Args>
+        [[nodiscard]] std::uint32_t binarySite() noexcept
+        {
+            static std::atomic<std::uint32_t> id{invalid_binary_site};
+
+            auto site = id.load(std::memory_order_acquire);
+            if (site == invalid_binary_site) {
+                //two threads racing here register the same decoder twice, which only costs a table entry
+                site = registerBinarySite(&decodeBinary<Args...>);
+                id.store(site, std::memory_order_release);
+            }
+            return site;
+        }
+
+        /**
+        * \brief Encode args into a binary record. Returns false if binary logging was disabled and the caller has to format the record itself
+        */
+        template <typename... Args>
+        [[nodiscard]] bool logBinary(const ChannelState& channel, LogLevel level, bool with_label, Args&&... args) noexcept
+        {
+            const auto site = binarySite<Args...>();
+            if (site == invalid_binary_site) {
+                return false;
+            }
+
+            //nested log calls (e.g. from inside an operator<<) encode their record behind the one of the outer call
+            auto& buffer = binaryScratchBuffer();
+            const auto start = buffer.size();
+
+            (BinaryCodec<Args>::encode(buffer, std::forward<Args>(args)), ...);
+
+            const bool written = writeBinaryRecord(site, channel, level, with_label, std::string_view{buffer}.substr(start));
+            buffer.resize(start);
+            return written;
+        }
+
+    } // namespace details
+} // namespace Logger
+
+#endif /* BINARY_H_ */
@@ -0,0 +1,242 @@
+/**
+*\file Channel.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Named logger instances with their own level and sinks
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef CHANNEL_H_
+#define CHANNEL_H_
+
+#include "Logger.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+//Like Channel::log(level, ...), but the arguments are only evaluated if the message is actually logged. level may be chosen
+//at runtime, see RAYCHELLOGGER_LOG
+#define RAYCHELLOGGER_LOG_TO(channel, level, ...)                                                                                \
+    do {                                                                                                                         \
+        const auto raychellogger_level_ = (level);                                                                               \
+        if (::Logger::details::isCompiledIn(raychellogger_level_)) {                                                             \
+            auto& raychellogger_channel_ = (channel);                                                                            \
+            auto& raychellogger_state_ = raychellogger_channel_.state();                                                         \
+            if (::Logger::details::shouldLog(raychellogger_state_, raychellogger_level_)) {                                      \
+                ::Logger::details::logUnchecked(raychellogger_state_, raychellogger_level_, true, __VA_ARGS__);                  \
+            } else if constexpr (RAYCHELLOGGER_COUNT_FILTERED) {                                                                 \
+                ::Logger::details::countFiltered(raychellogger_level_);                                                          \
+            }                                                                                                                    \
+        }                                                                                                                        \
+    } while (false)
+
+namespace Logger {
+
+    class Channel;
+
+    /**
+    * \brief Get the channel with the given name. It is created on first use. "default" is the defaultChannel()
+    */
+    [[nodiscard]] LOGGER_EXPORT Channel& channel(std::string_view name);
+
+    /**
+    * \brief Get the channel the free logging functions write to
+    */
+    [[nodiscard]] LOGGER_EXPORT Channel& defaultChannel() noexcept;
+
+    /**
+    * \brief A logger with its own minimum level and sinks. Labels, colors and the asynchronous, buffered and binary modes
+    * are shared by all channels. Get channels from Logger::channel(), they live until the program exits
+    */
+    class Channel
+    {
+        //queued records point to the state of their channel, so only these create channels and never destroy them early
+        friend Channel& channel(std::string_view name);
+        friend Channel& defaultChannel() noexcept;
+
+    public:
+        Channel(const Channel&) = delete;
+        Channel(Channel&&) = delete;
+
+        Channel& operator=(const Channel&) = delete;
+        Channel& operator=(Channel&&) = delete;
+
+        LOGGER_EXPORT ~Channel() noexcept;
+
+        [[nodiscard]] std::string_view name() const noexcept
+        {
+            return name_;
+        }
+
+        /**
+        * \brief Set the minimum level needed for a message to be logged to this channel. INFO by default
+        * 
+        * \return LogLevel The new minimum log level
+        */
+        LogLevel setMinimumLogLevel(LogLevel level) noexcept
+        {
+            state_.min_level.store(level, std::memory_order_relaxed);
+            return level;
+        }
+
+        [[nodiscard]] LogLevel minimumLogLevel() const noexcept
+        {
+            return state_.min_level.load(std::memory_order_relaxed);
+        }
+
+        /// \brief See Logger::setSampleRate()
+        void setSampleRate(LogLevel level, std::uint32_t one_in) noexcept
+        {
+            if (level != LogLevel::fatal) {
+                //NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+                state_.sample_rates[static_cast<std::size_t>(level)].store(one_in, std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] bool isEnabled(LogLevel level) const noexcept
+        {
+            return details::isEnabled(state_, level);
+        }
+
+        /// \brief Log a message with the provided level. Can log multiple objects seperated by a comma
+        template <typename... Args>
+        void log(LogLevel level, Args&&... args)
+        {
+            if (details::isCompiledIn(level)) {
+                details::logConcurrent(state_, level, true, std::forward<Args>(args)...);
+            }
+        }
+
+        /// \brief Log a message with the DEBUG level. Can log multiple objects seperated by comma
+        template <typename... Args>
+        void debug(Args&&... args)
+        {
+            if constexpr (details::isCompiledIn(LogLevel::debug)) {
+                details::logConcurrent(state_, LogLevel::debug, true, std::forward<Args>(args)...);
+            }
+        }
+
+        /// \brief Log a message with the INFO level. Can log multiple objects seperated by comma
+        template <typename... Args>
+        void info(Args&&... args)
+        {
+            if constexpr (details::isCompiledIn(LogLevel::info)) {
+                details::logConcurrent(state_, LogLevel::info, true, std::forward<Args>(args)...);
+            }
+        }
+
+        /// \brief Log a message with the WARN level. Can log multiple objects seperated by comma
+        template <typename... Args>
+        void warn(Args&&... args)
+        {
+            if constexpr (details::isCompiledIn(LogLevel::warn)) {
+                details::logConcurrent(state_, LogLevel::warn, true, std::forward<Args>(args)...);
+            }
+        }
+
+        /// \brief Log a message with the ERROR level. Can log multiple objects seperated by comma
+        template <typename... Args>
+        void error(Args&&... args)
+        {
+            if constexpr (details::isCompiledIn(LogLevel::error)) {
+                details::logConcurrent(state_, LogLevel::error, true, std::forward<Args>(args)...);
+            }
+        }
+
+        /// \brief Log a message with the CRITICAL level. Can log multiple objects seperated by comma
+        template <typename... Args>
+        void critical(Args&&... args)
+        {
+            if constexpr (details::isCompiledIn(LogLevel::critical)) {
+                details::logConcurrent(state_, LogLevel::critical, true, std::forward<Args>(args)...);
+            }
+        }
+
+        /// \brief Log a message with the FATAL level. Can log multiple objects seperated by comma
+        template <typename... Args>
+        void fatal(Args&&... args)
+        {
+            if constexpr (details::isCompiledIn(LogLevel::fatal)) {
+                details::logConcurrent(state_, LogLevel::fatal, true, std::forward<Args>(args)...);
+            }
+        }
+
+        /**
+        * \brief Set the output stream of the primary sink of this channel
+        */
+        LOGGER_EXPORT void setOutStream(std::ostream& os);
+
+        /// \brief See Logger::addSink()
+        LOGGER_EXPORT SinkId addSink(std::ostream& os, const SinkOptions& options = {});
+
+        /// \brief See Logger::addFileSink()
+        LOGGER_EXPORT std::optional<SinkId> addFileSink(
+            std::string_view directory, std::string_view fileName, const SinkOptions& options = {},
+            const FileSinkOptions& file_options = {});
+
+        /// \brief See Logger::addNetworkSink()
+        LOGGER_EXPORT std::optional<SinkId> addNetworkSink(
+            std::string_view host, std::uint16_t port, const SinkOptions& options = {},
+            const NetworkSinkOptions& network_options = {});
+
+        /// \brief See Logger::removeSink()
+        LOGGER_EXPORT bool removeSink(SinkId id);
+
+        /// \brief See Logger::setSinkOptions()
+        LOGGER_EXPORT bool setSinkOptions(SinkId id, const SinkOptions& options) noexcept;
+
+        /**
+        * \brief Write everything that is still buffered to the sinks of this channel and flush them
+        */
+        LOGGER_EXPORT void flush() noexcept;
+
+        [[nodiscard]] details::ChannelState& state() noexcept
+        {
+            return state_;
+        }
+
+    private:
+        /**
+        * \brief Create a channel with its own sinks. The primary sink writes to std::cout
+        */
+        LOGGER_EXPORT explicit Channel(std::string name);
+
+        /**
+        * \brief Create a channel that writes to existing sinks
+        */
+        LOGGER_EXPORT Channel(std::string name, details::SinkRegistry& sinks) noexcept;
+
+        /**
+        * \brief Create a channel that writes to existing sinks and keeps its minimum level and sample rates in state
+        */
+        LOGGER_EXPORT Channel(std::string name, details::SinkRegistry& sinks, details::ChannelState& state) noexcept;
+
+        std::string name_;
+        std::unique_ptr<details::SinkRegistry> ownSinks_; //empty if the channel writes to existing sinks
+        details::ChannelState ownState_; //unused if the channel was given a state
+        details::ChannelState& state_;
+    };
+
+} // namespace Logger
+
+#endif /* CHANNEL_H_ */
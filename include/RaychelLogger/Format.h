@@ -0,0 +1,293 @@
+/**
+*\file Format.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Allocation-free formatting of log arguments
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include "Helper.h"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+//libc++ and older libstdc++ versions only implement std::to_chars for integers
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    #define RAYCHELLOGGER_HAS_FLOAT_TO_CHARS 1
+#else
+    #include <cstdio>
+    #define RAYCHELLOGGER_HAS_FLOAT_TO_CHARS 0
+#endif
+
+namespace Logger {
+
+    /**
+    * \brief Extension point for types that should be logged without going through operator<<. Specializations need a
+    * static void format(std::string& out, const T& obj) noexcept that appends the representation of obj to out
+    * 
+    * \tparam T Type that is formatted
+    */
+    template <typename T>
+    struct formatter
+    {};
+
+} // namespace Logger
+
+namespace Logger::details {
+
+    template <typename T, typename = void>
+    struct has_formatter : std::false_type
+    {};
+
+    template <typename T>
+    struct has_formatter<T, std::void_t<decltype(formatter<T>::format(std::declval<std::string&>(), std::declval<const T&>()))>>
+        : std::true_type
+    {};
+
+    template <typename T>
+    constexpr bool has_formatter_v = has_formatter<T>::value;
+
+    /**
+    * \brief Get the buffer the calling thread formats its messages into. Its capacity is kept between records
+    * 
+    * \return std::string& Thread-local message buffer
+    */
+    [[nodiscard]] LOGGER_EXPORT std::string& messageBuffer() noexcept;
+
+    /**
+    * \brief Get a stream that appends to messageBuffer(), or to the buffer set by retargetMessageStream(). Only used for
+    * types that have nothing but an operator<<
+    * 
+    * \return std::ostream& Thread-local stream with its formatting state reset to the defaults
+    */
+    [[nodiscard]] LOGGER_EXPORT std::ostream& messageStream() noexcept;
+
+    /**
+    * \brief Make messageStream() append to target
+    * 
+    * \return std::string* The previous target, to be restored once the object is written
+    */
+    [[nodiscard]] LOGGER_EXPORT std::string* retargetMessageStream(std::string* target) noexcept;
+
+    template <typename T>
+    constexpr bool is_char_v =
+        std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+    template <typename T>
+    constexpr bool is_c_string_v = std::is_pointer_v<T>&& is_char_v<std::remove_cv_t<std::remove_pointer_t<T>>> &&
+                                   !std::is_volatile_v<std::remove_pointer_t<T>>;
+
+    /**
+    * \brief Append an integer in base 10
+    */
+    template <typename T>
+    void appendInteger(std::string& buffer, T value, int base = 10) noexcept
+    {
+        std::array<char, 72> chars{};
+        const auto result = std::to_chars(chars.data(), chars.data() + chars.size(), value, base);
+        buffer.append(chars.data(), static_cast<std::size_t>(result.ptr - chars.data()));
+    }
+
+    /**
+    * \brief Append an address as lowercase hex digits without leading zeros
+    */
+    inline void appendHex(std::string& buffer, std::uintptr_t value) noexcept
+    {
+        constexpr std::string_view hex_digits = "0123456789abcdef";
+
+        std::array<char, sizeof(std::uintptr_t) * 2> chars{};
+        auto pos = chars.size();
+        do {
+            chars[--pos] = hex_digits[value & 0xfU];
+            value >>= 4U;
+        } while (value != 0);
+        buffer.append(chars.data() + pos, chars.size() - pos); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    /**
+    * \brief Append a floating point number. The output is the same as std::ostream with its default flags (%g, 6 digits)
+    */
+    template <typename T>
+    void appendFloat(std::string& buffer, T value) noexcept
+    {
+        std::array<char, 64> chars{};
+#if RAYCHELLOGGER_HAS_FLOAT_TO_CHARS
+        const auto result = std::to_chars(chars.data(), chars.data() + chars.size(), value, std::chars_format::general, 6);
+        buffer.append(chars.data(), static_cast<std::size_t>(result.ptr - chars.data()));
+#else
+        const auto len = std::snprintf(chars.data(), chars.size(), "%Lg", static_cast<long double>(value));
+        if (len > 0) {
+            buffer.append(chars.data(), static_cast<std::size_t>(len));
+        }
+#endif
+    }
+
+    /**
+    * \brief Append the {type_name} at {pointer} representation of an object
+    * 
+    * \tparam T Type whose name is printed
+    * \param address Address that is printed
+    */
+    template <typename T>
+    void appendAddress(std::string& buffer, const volatile void* address) noexcept
+    {
+        buffer.append(address_prefix<T>::value);
+        appendHex(buffer, reinterpret_cast<std::uintptr_t>(address)); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+
+    /**
+    * \brief A key-value pair created by Logger::kv(). Stored in the fields of the record instead of its message
+    * 
+    * \tparam V Type of the value, a const reference or a pointer to a string
+    */
+    template <typename V>
+    struct KeyValue
+    {
+        std::string_view key;
+        V value;
+    };
+
+    template <typename T>
+    struct is_key_value : std::false_type
+    {};
+
+    template <typename V>
+    struct is_key_value<KeyValue<V>> : std::true_type
+    {};
+
+    template <typename T>
+    constexpr bool is_key_value_v = is_key_value<T>::value;
+
+    /// \brief How the value of a field is encoded. Numbers and booleans are written without quotes
+    enum class FieldKind : char { string, number, boolean };
+
+    /**
+    * \brief Get the buffer the calling thread collects the fields of its records in. Fields are only encoded when the
+    * record is finished
+    * 
+    * \return std::string& Thread-local field buffer
+    */
+    [[nodiscard]] LOGGER_EXPORT std::string& structuredFields() noexcept;
+
+    /**
+    * \brief Kind of a field with a value of type V. value is the formatted value, floating point numbers that are not
+    * finite become strings
+    */
+    template <typename V>
+    [[nodiscard]] FieldKind fieldKind(std::string_view value) noexcept
+    {
+        using type = std::remove_cv_t<std::remove_reference_t<V>>;
+
+        if constexpr (std::is_same_v<type, bool>) {
+            return FieldKind::boolean;
+        } else if constexpr (std::is_integral_v<type> && !is_char_v<type>) {
+            return FieldKind::number;
+        } else if constexpr (std::is_floating_point_v<type>) {
+            return value.find_first_of("0123456789") == std::string_view::npos ? FieldKind::string : FieldKind::number;
+        } else {
+            return FieldKind::string;
+        }
+    }
+
+    /**
+    * \brief Append a field to structuredFields() as kind, key size, key, value size and value
+    * 
+    * \tparam V Type of the value
+    * \param key Name of the field
+    * \param format_value Appends the value to the string it is passed
+    */
+    template <typename V, typename F>
+    void appendField(std::string_view key, F&& format_value) noexcept
+    {
+        //the value is formatted behind the message like every other argument, operator<< can only append to messageBuffer()
+        auto& text = messageBuffer();
+        const auto start = text.size();
+        format_value(text);
+        const auto value = std::string_view{text}.substr(start);
+
+        auto& fields = structuredFields();
+        const auto key_size = static_cast<std::uint32_t>(key.size());
+        const auto value_size = static_cast<std::uint32_t>(value.size());
+        fields.push_back(static_cast<char>(fieldKind<V>(value)));
+        fields.append(reinterpret_cast<const char*>(&key_size), sizeof(key_size)); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        fields.append(key);
+        fields.append(reinterpret_cast<const char*>(&value_size), sizeof(value_size)); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        fields.append(value);
+
+        text.resize(start);
+    }
+
+    /**
+    * \brief Append the string representation of obj to buffer.
+    * Key-value pairs are added to the fields of the record, types with a Logger::formatter specialization use it, built-in
+    * types are converted directly, objects that can be converted using streams go through messageStream()
+    * and everything else is printed as {type_name} at {address}
+    * 
+    * \tparam T Type of the object
+    * \param buffer Buffer to append to
+    * \param obj Object to convert
+    */
+    template <typename T>
+    void formatArg(std::string& buffer, T&& obj) noexcept
+    {
+        using type = std::remove_cv_t<std::remove_reference_t<T>>;
+
+        if constexpr (is_key_value_v<type>) {
+            appendField<decltype(obj.value)>(obj.key, [&obj](std::string& text) { formatArg(text, obj.value); });
+        } else if constexpr (has_formatter_v<type>) {
+            formatter<type>::format(buffer, obj);
+        } else if constexpr (std::is_same_v<type, bool>) {
+            buffer.push_back(obj ? '1' : '0');
+        } else if constexpr (is_char_v<type>) {
+            buffer.push_back(static_cast<char>(obj));
+        } else if constexpr (std::is_integral_v<type>) {
+            appendInteger(buffer, obj);
+        } else if constexpr (std::is_floating_point_v<type>) {
+            appendFloat(buffer, obj);
+        } else if constexpr (is_c_string_v<std::decay_t<T>>) {
+            const auto* str = reinterpret_cast<const char*>(obj); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            buffer.append(str == nullptr ? "(null)" : str);
+        } else if constexpr (std::is_convertible_v<const type&, std::string_view>) {
+            buffer.append(std::string_view{obj});
+        } else if constexpr (std::is_pointer_v<type> && std::is_object_v<std::remove_pointer_t<type>>) {
+            appendAddress<std::remove_reference_t<T>>(buffer, obj);
+        } else if constexpr (is_to_stream_writable_v<std::ostream, T>) {
+            //the stream is shared with nested log calls in the operator<<, each puts back the target it found
+            auto* const previous = retargetMessageStream(&buffer);
+            const Finally restore{[previous]() noexcept { static_cast<void>(retargetMessageStream(previous)); }};
+            messageStream() << std::forward<T>(obj);
+        } else {
+            appendAddress<std::remove_reference_t<T>>(buffer, std::addressof(obj));
+        }
+    }
+} // namespace Logger::details
+
+#endif /* FORMAT_H_ */
@@ -0,0 +1,247 @@
+/**
+*\file FormatString.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Format strings that are parsed at compile time
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef FORMATSTRING_H_
+#define FORMATSTRING_H_
+
+#include "Format.h"
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+* \brief Create a format string that is parsed at compile time, e.g. info(RAYCHELLOGGER_FMT("req {} took {}ms\n"), id, ms).
+* Every {} is replaced by the next argument, {{ and }} are literal braces. Key-value pairs may follow the arguments for the slots.
+* Every use creates its own type, so the literal text never has to be copied into binary records
+*/
+#define RAYCHELLOGGER_FMT(format_string)                                                                                         \
+    ([] {                                                                                                                        \
+        struct FormatSource                                                                                                      \
+        {                                                                                                                        \
+            static constexpr std::string_view value() noexcept                                                                  \
+            {                                                                                                                    \
+                return format_string;                                                                                            \
+            }                                                                                                                    \
+        };                                                                                                                       \
+        return ::Logger::details::FormatString<FormatSource>{};                                                                  \
+    }())
+
+namespace Logger::details {
+
+    constexpr std::size_t invalid_format = std::numeric_limits<std::size_t>::max();
+
+    /**
+    * \brief Count the {} slots of a format string
+    * 
+    * \return invalid_format if the string has a brace that is neither part of {} nor escaped
+    */
+    [[nodiscard]] constexpr std::size_t countFormatSlots(std::string_view text) noexcept
+    {
+        std::size_t slots = 0;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            const bool has_next = i + 1 < text.size();
+            if (text[i] == '{' && has_next && text[i + 1] == '}') {
+                slots++;
+                i++;
+            } else if (text[i] == '{' || text[i] == '}') {
+                if (!has_next || text[i + 1] != text[i]) {
+                    return invalid_format;
+                }
+                i++;
+            }
+        }
+        return slots;
+    }
+
+    struct FormatSegment
+    {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    /**
+    * \brief The literal text of a format string with its escape sequences resolved, split into the segments between its slots
+    */
+    template <std::size_t TextCapacity, std::size_t Slots>
+    struct FormatLayout
+    {
+        std::array<char, TextCapacity> text{};
+        std::size_t text_size{0};
+        std::array<FormatSegment, Slots + 1> segments{};
+    };
+
+    template <std::size_t TextCapacity, std::size_t Slots>
+    [[nodiscard]] constexpr FormatLayout<TextCapacity, Slots> parseFormat(std::string_view source) noexcept
+    {
+        FormatLayout<TextCapacity, Slots> layout{};
+        std::size_t segment = 0;
+
+        for (std::size_t i = 0; i < source.size(); i++) {
+            const char c = source[i];
+            if (c == '{' && i + 1 < source.size() && source[i + 1] == '}') {
+                layout.segments[segment].size = layout.text_size - layout.segments[segment].offset;
+                layout.segments[++segment].offset = layout.text_size;
+                i++;
+                continue;
+            }
+            if (c == '{' || c == '}') {
+                i++; //the second brace of an escape sequence
+            }
+            layout.text[layout.text_size++] = c;
+        }
+        layout.segments[segment].size = layout.text_size - layout.segments[segment].offset;
+
+        return layout;
+    }
+
+    /**
+    * \brief A format string that was parsed at compile time. Created by RAYCHELLOGGER_FMT
+    * 
+    * \tparam Source Type with a static constexpr value() that returns the format string
+    */
+    template <typename Source>
+    struct FormatString
+    {
+        static constexpr std::string_view source = Source::value();
+        static_assert(
+            countFormatSlots(source) != invalid_format, "Format strings may only contain {} and the escape sequences {{ and }}");
+
+        static constexpr std::size_t slots = countFormatSlots(source) == invalid_format ? 0 : countFormatSlots(source);
+        static constexpr auto layout = parseFormat<source.size(), slots>(source);
+
+        /// \brief Literal text in front of slot index, or behind the last slot
+        [[nodiscard]] static std::string_view segment(std::size_t index) noexcept
+        {
+            const auto& [offset, size] = layout.segments[index]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            return std::string_view{layout.text.data(), layout.text_size}.substr(offset, size);
+        }
+    };
+
+    template <typename T>
+    struct is_format_string : std::false_type
+    {};
+
+    template <typename Source>
+    struct is_format_string<FormatString<Source>> : std::true_type
+    {};
+
+    template <typename T>
+    constexpr bool is_format_string_v = is_format_string<std::remove_cv_t<std::remove_reference_t<T>>>::value;
+
+    template <typename... Args>
+    constexpr bool starts_with_format_v = false;
+
+    template <typename T, typename... Args>
+    constexpr bool starts_with_format_v<T, Args...> = is_format_string_v<T>;
+
+    /**
+    * \brief Check that the arguments for the slots come first and are followed only by key-value pairs
+    */
+    template <std::size_t Slots, typename... Args, std::size_t... I>
+    [[nodiscard]] constexpr bool formatArgsValid(std::index_sequence<I...> /*unused*/) noexcept
+    {
+        return ((is_key_value_v<std::remove_cv_t<std::remove_reference_t<Args>>> == (I >= Slots)) && ...);
+    }
+
+    /**
+    * \brief Upper bound of the formatted size of obj for numbers and strings with a known size, a guess for everything else
+    */
+    template <typename T>
+    [[nodiscard]] std::size_t formattedSizeBound(const T& obj) noexcept
+    {
+        using type = std::remove_cv_t<std::remove_reference_t<T>>;
+
+        if constexpr (is_key_value_v<type>) {
+            return 0; //part of the fields, not of the message
+        } else if constexpr (std::is_same_v<type, bool> || is_char_v<type>) {
+            return 1;
+        } else if constexpr (std::is_integral_v<type>) {
+            return std::numeric_limits<type>::digits10 + 2;
+        } else if constexpr (std::is_floating_point_v<type>) {
+            return 16; //6 significant digits with sign, decimal point and exponent
+        } else if constexpr (!is_c_string_v<std::decay_t<T>> && std::is_convertible_v<const type&, std::string_view>) {
+            return std::string_view{obj}.size();
+        } else {
+            return 32;
+        }
+    }
+
+    /**
+    * \brief Append the segments of Format with the output of append_arg for every slot in between
+    * 
+    * \param append_arg Called with buffer and a std::integral_constant that holds the index of the slot
+    */
+    template <typename Format, typename F, std::size_t... I>
+    void appendSegments(std::string& buffer, F&& append_arg, std::index_sequence<I...> /*unused*/) noexcept
+    {
+        ((buffer.append(Format::segment(I)), append_arg(buffer, std::integral_constant<std::size_t, I>{})), ...);
+        buffer.append(Format::segment(sizeof...(I)));
+    }
+
+    /**
+    * \brief Format the key-value pairs behind the arguments for the slots
+    */
+    template <std::size_t Slots, typename Tuple, std::size_t... I>
+    void appendTrailing(std::string& buffer, Tuple&& arg_tuple, std::index_sequence<I...> /*unused*/) noexcept
+    {
+        (formatArg(buffer, std::get<Slots + I>(std::forward<Tuple>(arg_tuple))), ...);
+    }
+
+    /**
+    * \brief Format args into buffer as described by Format. The buffer is grown once for the whole message
+    */
+    template <typename Format, typename... Args>
+    void appendFormatted(std::string& buffer, Args&&... args) noexcept
+    {
+        constexpr auto slots = Format::slots;
+        static_assert(sizeof...(Args) >= slots, "The format string has more {} than there are arguments");
+        static_assert(
+            formatArgsValid<slots, Args...>(std::index_sequence_for<Args...>{}),
+            "Every {} needs an argument that is not a key-value pair, other arguments have to be key-value pairs");
+
+        buffer.reserve(buffer.size() + Format::layout.text_size + (formattedSizeBound(args) + ... + 0));
+
+        auto arg_tuple = std::forward_as_tuple(std::forward<Args>(args)...);
+        appendSegments<Format>(
+            buffer,
+            [&arg_tuple](std::string& out, auto index) {
+                formatArg(out, std::get<decltype(index)::value>(std::move(arg_tuple)));
+            },
+            std::make_index_sequence<slots>{});
+
+        appendTrailing<slots>(buffer, std::move(arg_tuple), std::make_index_sequence<sizeof...(Args) - slots>{});
+    }
+
+} // namespace Logger::details
+
+#endif /* FORMATSTRING_H_ */
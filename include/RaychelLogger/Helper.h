@@ -29,7 +29,7 @@
 #ifndef HELPER_H_
 #define HELPER_H_
 
-#ifdef _WIN32
+#if defined(_WIN32) && !defined(RAYCHELLOGGER_STATIC)
     #ifdef RaychelLogger_EXPORTS
         #define LOGGER_EXPORT __declspec(dllexport)
     #else
@@ -39,6 +39,7 @@
     #define LOGGER_EXPORT
 #endif
 
+#include <array>
 #include <chrono>
 #include <string_view>
 #include <type_traits>
@@ -81,6 +82,33 @@ namespace Logger::details {
         return name;
     }
 
+    /**
+    * \brief The "{type_name} at 0x" part of the representation of objects that cannot be printed. Built at compile time
+    * 
+    * \tparam T Type whose name is printed
+    */
+    template <typename T>
+    struct address_prefix
+    {
+    private:
+        static constexpr std::string_view name = type_name<T>();
+        static constexpr std::string_view separator = " at 0x";
+
+        static constexpr auto chars = [] {
+            std::array<char, name.size() + separator.size()> result{};
+            for (std::size_t i = 0; i < name.size(); i++) {
+                result[i] = name[i];
+            }
+            for (std::size_t i = 0; i < separator.size(); i++) {
+                result[name.size() + i] = separator[i];
+            }
+            return result;
+        }();
+
+    public:
+        static constexpr std::string_view value{chars.data(), chars.size()};
+    };
+
     template <typename F>
     class Finally
     {
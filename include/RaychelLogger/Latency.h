@@ -0,0 +1,186 @@
+/**
+*\file Latency.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Scoped timers and per-label latency histograms
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+namespace Logger {
+
+    /**
+    * \brief Summary of the durations recorded by a LatencyHistogram. Percentiles are accurate to about 3%
+    */
+    struct LatencySummary
+    {
+        std::uint64_t count{0};
+        std::chrono::nanoseconds min{0};
+        std::chrono::nanoseconds max{0};
+        std::chrono::nanoseconds mean{0};
+        std::chrono::nanoseconds p50{0};
+        std::chrono::nanoseconds p99{0};
+        std::chrono::nanoseconds p999{0};
+    };
+
+    /**
+    * \brief Log-linear histogram of durations (32 buckets per power of two, like HdrHistogram with ~1.5 significant digits).
+    * Recording is lock-free and can happen from any number of threads
+    */
+    class LatencyHistogram
+    {
+        static constexpr std::uint64_t sub_bucket_bits = 5;
+        static constexpr std::uint64_t sub_buckets = 1U << sub_bucket_bits;
+        static constexpr std::size_t bucket_count = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+    public:
+        LatencyHistogram() = default;
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram(LatencyHistogram&&) = delete;
+
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(LatencyHistogram&&) = delete;
+
+        ~LatencyHistogram() = default;
+
+        /**
+        * \brief Record a single duration. Negative durations are recorded as 0
+        */
+        void record(std::chrono::nanoseconds duration) noexcept
+        {
+            const auto value = static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(duration.count(), 0));
+
+            buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+            sum_.fetch_add(value, std::memory_order_relaxed);
+
+            auto current_min = min_.load(std::memory_order_relaxed);
+            while (value < current_min && !min_.compare_exchange_weak(current_min, value, std::memory_order_relaxed)) {
+            }
+            auto current_max = max_.load(std::memory_order_relaxed);
+            while (value > current_max && !max_.compare_exchange_weak(current_max, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        /**
+        * \brief Compute count, min, max, mean and percentiles of everything recorded since the last reset
+        */
+        [[nodiscard]] LOGGER_EXPORT LatencySummary summary() const noexcept;
+
+        /**
+        * \brief Forget everything recorded so far. Durations recorded concurrently may or may not survive the reset
+        */
+        LOGGER_EXPORT void reset() noexcept;
+
+    private:
+        [[nodiscard]] static constexpr std::size_t bucketFor(std::uint64_t value) noexcept
+        {
+            if (value < sub_buckets) {
+                return static_cast<std::size_t>(value);
+            }
+            std::uint64_t msb = 0;
+            for (auto v = value; v > 1; v >>= 1U) {
+                msb++;
+            }
+            const auto shift = msb - sub_bucket_bits;
+            return static_cast<std::size_t>(shift * sub_buckets + (value >> shift));
+        }
+
+        [[nodiscard]] static constexpr std::uint64_t highestValueIn(std::size_t bucket) noexcept
+        {
+            if (bucket < sub_buckets) {
+                return bucket;
+            }
+            const auto shift = bucket / sub_buckets - 1;
+            const auto mantissa = bucket - shift * sub_buckets;
+            return ((mantissa + 1) << shift) - 1;
+        }
+
+        std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+        std::atomic<std::uint64_t> count_{0};
+        std::atomic<std::uint64_t> sum_{0};
+        std::atomic<std::uint64_t> min_{std::numeric_limits<std::uint64_t>::max()};
+        std::atomic<std::uint64_t> max_{0};
+    };
+
+    /**
+    * \brief Get the histogram associated with label, creating it if necessary. The reference stays valid for the whole
+    * program, so hot code should look it up once and keep it
+    * 
+    * \param label Label of the histogram
+    * \return LatencyHistogram& The histogram
+    */
+    [[nodiscard]] LOGGER_EXPORT LatencyHistogram& latencyHistogram(std::string_view label);
+
+    /**
+    * \brief Start a timer that records its duration into histogram when it goes out of scope
+    * 
+    * \param histogram Histogram the duration is recorded into
+    * \return An object that records the duration when it is destroyed
+    */
+    [[nodiscard]] inline auto scopedTimer(LatencyHistogram& histogram) noexcept
+    {
+        return details::Finally{[&histogram, timer = startTimer()]() noexcept {
+            histogram.record(endTimer<std::chrono::nanoseconds>(timer));
+        }};
+    }
+
+    /**
+    * \brief Start a timer that records its duration into the histogram associated with label when it goes out of scope
+    * 
+    * \param label Label of the histogram
+    * \return An object that records the duration when it is destroyed
+    */
+    [[nodiscard]] inline auto scopedTimer(std::string_view label)
+    {
+        return scopedTimer(latencyHistogram(label));
+    }
+
+    /**
+    * \brief Log one line per histogram with its count, min, mean, max and percentiles
+    * 
+    * \param level Level used for logging the statistics
+    * \param reset If the histograms should be reset afterwards, so the next call only reports the next interval
+    */
+    LOGGER_EXPORT void logLatencyStats(LogLevel level = LogLevel::log, bool reset = true);
+
+    /**
+    * \brief Reset every histogram
+    */
+    LOGGER_EXPORT void resetLatencyStats() noexcept;
+
+} // namespace Logger
+
+#endif /* LATENCY_H_ */
@@ -33,14 +33,52 @@
     #error "C++17 compilation is required!"
 #endif
 
+#include "Binary.h"
+#include "Format.h"
+#include "FormatString.h"
 #include "Helper.h"
 
 #include <array>
+#include <atomic>
 #include <chrono>
-#include <sstream>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+
+//Messages below this level are removed at compile time. Set it to one of the LogLevel names, e.g. -DRAYCHELLOGGER_COMPILE_LEVEL=warn
+#ifndef RAYCHELLOGGER_COMPILE_LEVEL
+    #define RAYCHELLOGGER_COMPILE_LEVEL debug
+#endif
+
+//Set it to 1 to count records that do not pass the minimum log level in Logger::stats(). Off by default because it
+//turns the filtered path from a load and a branch into a function call. Use the same value in the whole program
+#ifndef RAYCHELLOGGER_COUNT_FILTERED
+    #define RAYCHELLOGGER_COUNT_FILTERED 0
+#endif
+
+//Like Logger::log(level, ...), but the arguments are only evaluated if the message is actually logged. level may be chosen at
+//runtime and is evaluated exactly once, a constant level below RAYCHELLOGGER_COMPILE_LEVEL still removes the whole call
+#define RAYCHELLOGGER_LOG(level, ...)                                                                                            \
+    do {                                                                                                                         \
+        const auto raychellogger_level_ = (level);                                                                               \
+        if (::Logger::details::isCompiledIn(raychellogger_level_)) {                                                             \
+            auto& raychellogger_state_ = ::Logger::details::defaultChannelState();                                               \
+            if (::Logger::details::shouldLog(raychellogger_state_, raychellogger_level_)) {                                      \
+                ::Logger::details::logUnchecked(raychellogger_state_, raychellogger_level_, true, __VA_ARGS__);                  \
+            } else if constexpr (RAYCHELLOGGER_COUNT_FILTERED) {                                                                 \
+                ::Logger::details::countFiltered(raychellogger_level_);                                                          \
+            }                                                                                                                    \
+        }                                                                                                                        \
+    } while (false)
+
+#define RAYCHELLOGGER_DEBUG(...) RAYCHELLOGGER_LOG(::Logger::LogLevel::debug, __VA_ARGS__)
+#define RAYCHELLOGGER_INFO(...) RAYCHELLOGGER_LOG(::Logger::LogLevel::info, __VA_ARGS__)
+#define RAYCHELLOGGER_WARN(...) RAYCHELLOGGER_LOG(::Logger::LogLevel::warn, __VA_ARGS__)
+#define RAYCHELLOGGER_ERROR(...) RAYCHELLOGGER_LOG(::Logger::LogLevel::error, __VA_ARGS__)
+#define RAYCHELLOGGER_CRITICAL(...) RAYCHELLOGGER_LOG(::Logger::LogLevel::critical, __VA_ARGS__)
+#define RAYCHELLOGGER_FATAL(...) RAYCHELLOGGER_LOG(::Logger::LogLevel::fatal, __VA_ARGS__)
 
 #define RAYCHELLOGGER_LOCK_STREAM()                                                                                              \
     ::Logger::details::lockStream();                                                                                             \
@@ -49,152 +87,251 @@
 namespace Logger {
     enum class LogLevel : size_t { debug, info, warn, error, critical, fatal, log };
 
+    /// \brief What to do with a new record if the asynchronous queue is full
+    enum class OverflowPolicy { block, drop_newest, drop_oldest };
+
+    /// \brief Timestamp in front of every record. raw is the steady clock in nanoseconds, the cheapest to take and to print
+    enum class TimestampFormat { none, seconds, milliseconds, microseconds, raw };
+
+    /**
+    * \brief Layout of every record. text is "[LABEL] message key=value", logfmt is "time=... level=LABEL msg=... key=value"
+    * and json is one object per line with the fields time, level, msg and the key-value pairs of the record
+    */
+    enum class RecordFormat { text, logfmt, json };
+
     using namespace std::string_view_literals;
 
     using timePoint_t = std::chrono::high_resolution_clock::time_point;
 
+    /// \brief Lowest level that is compiled into the program. See RAYCHELLOGGER_COMPILE_LEVEL
+    constexpr LogLevel compileTimeLevel = LogLevel::RAYCHELLOGGER_COMPILE_LEVEL;
+
     namespace details {
 
         /**
-        * \brief Get the required level for a message to be logged
-        * 
-        * \return Current minimum log level
+        * \brief Check if messages with level are compiled into the program. FATAL messages are never removed
         */
-        [[nodiscard]] LOGGER_EXPORT LogLevel requiredLevel() noexcept;
+        [[nodiscard]] constexpr bool isCompiledIn(LogLevel level) noexcept
+        {
+            return level >= compileTimeLevel || level == LogLevel::fatal;
+        }
+
+        class SinkRegistry;
 
         /**
-        * \brief Set the minimum required log level
+        * \brief The part of a Channel every record needs. Lives as long as the program, so records may keep pointers to it
         */
-        LOGGER_EXPORT void setLogLevel(LogLevel) noexcept;
+        struct ChannelState
+        {
+            std::atomic<LogLevel> min_level{LogLevel::info};
+            SinkRegistry* sinks{nullptr};
+
+            //1 in sample_rates[level] records that pass min_level are kept. 0 and 1 keep all of them
+            std::array<std::atomic<std::uint32_t>, static_cast<std::size_t>(LogLevel::log) + 1> sample_rates{};
+        };
 
         /**
-        * \brief Part of the type-ignorant printing API
+        * \brief State of the channel the free logging functions write to. A variable instead of a function, so checking the
+        * level of a record is inlined even when the logger is a shared library
         */
-        LOGGER_EXPORT void printWithoutLabel(std::string_view) noexcept;
+        LOGGER_EXPORT extern ChannelState defaultState; //NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
         /**
-        * \brief Part of the type-ignorant printing API
+        * \brief Get the state of the channel the free logging functions write to
         */
-        LOGGER_EXPORT void print(std::string_view) noexcept;
+        [[nodiscard]] inline ChannelState& defaultChannelState() noexcept
+        {
+            return defaultState;
+        }
 
         /**
-        * \brief Lock the output stream so logging is thread-safe
+        * \brief Get the required level for a message to be logged. Does not lock the output stream
+        * 
+        * \return Current minimum log level
         */
-        LOGGER_EXPORT void lockStream();
+        [[nodiscard]] inline LogLevel requiredLevel() noexcept
+        {
+            return defaultState.min_level.load(std::memory_order_relaxed);
+        }
 
         /**
-        * \brief Unlock the output stream so logging is thread-safe
+        * \brief Check if a message with level passes the minimum log level. FATAL messages cannot be blocked
         */
-        LOGGER_EXPORT void unlockStream() noexcept;
+        [[nodiscard]] inline bool isEnabled(LogLevel level) noexcept
+        {
+            return level >= details::requiredLevel() || level == LogLevel::fatal;
+        }
 
         /**
-        * \brief Get the {type_name} at {pointer} representation of an object that cannot be converted using streams
-        * 
-        * \tparam T Type of the object
-        * \param obj Object to be converted
-        * \return std::string Representation of obj
+        * \brief Check if a message with level passes the minimum log level of channel. FATAL messages cannot be blocked
         */
-        template <typename T>
-        [[nodiscard]] std::string getRepNonStreamable(T&& obj) noexcept
+        [[nodiscard]] inline bool isEnabled(const ChannelState& channel, LogLevel level) noexcept
         {
-            std::ostringstream interpreter;
-
-            interpreter << details::type_name<std::remove_reference_t<T>>() << " at 0x" << std::hex
-                        << reinterpret_cast<std::uintptr_t>(&obj); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-
-            return interpreter.str();
+            return level >= channel.min_level.load(std::memory_order_relaxed) || level == LogLevel::fatal;
         }
 
         /**
-        * \brief Get the string representation of an object that can be converted using streams
-        * 
-        * \tparam T Type of the object
-        * \param obj Object to convert
-        * \return std::string String representation of the object
+        * \brief Cheap per-thread random number for sampling decisions. Not suitable for anything else
         */
-        template <typename T>
-        [[nodiscard]] std::string getRepStreamable(T&& obj) noexcept
+        [[nodiscard]] inline std::uint32_t sampleRandom() noexcept
         {
-            std::ostringstream interpreter;
+            //splitmix64, seeded with the address of the state so every thread draws different numbers
+            thread_local std::uint64_t state{0};
+            if (state == 0) {
+                state = reinterpret_cast<std::uintptr_t>(&state); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+            }
+            auto z = state += 0x9E3779B97F4A7C15ULL;
+            z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+            return static_cast<std::uint32_t>((z ^ (z >> 31U)) >> 32U);
+        }
 
-            interpreter << obj;
+        /**
+        * \brief Returns true for 1 in n calls on average. n of 0 and 1 always return true
+        */
+        [[nodiscard]] inline bool sampleOneIn(std::uint32_t n) noexcept
+        {
+            //maps the random number onto [0, n) without a division
+            return n <= 1 || ((std::uint64_t{sampleRandom()} * n) >> 32U) == 0;
+        }
 
-            return interpreter.str();
+        /**
+        * \brief Check if a record with level is kept by the sample rate of channel
+        */
+        [[nodiscard]] inline bool isSampled(const ChannelState& channel, LogLevel level) noexcept
+        {
+            //NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            return sampleOneIn(channel.sample_rates[static_cast<std::size_t>(level)].load(std::memory_order_relaxed));
         }
 
         /**
-        * \brief Get the string representation of a pointer
-        * 
-        * \tparam T Type of the pointer
-        * \param ptr Pointer to convert
-        * \return std::string String representation of the object
+        * \brief Trace ID of the calling thread. 0 if it has none
         */
-        template <typename T, typename = std::enable_if_t<!std::is_same_v<std::remove_const_t<T>, char>>>
-        [[nodiscard]] std::string getRepStreamable(T* ptr) noexcept
+        [[nodiscard]] inline std::uint64_t& currentTraceId() noexcept
         {
-            return getRepNonStreamable(ptr);
+            thread_local std::uint64_t trace_id{0};
+            return trace_id;
         }
 
         /**
-        * \brief Get the string representation of a C-style string
-        * 
-        * \param ptr A C-style string
-        * \return std::string That same string, but better
+        * \brief Check if trace_id was passed to Logger::enableTrace(). Does not lock
         */
-        template <>
-        [[nodiscard]] inline std::string getRepStreamable<const char, void>(const char* ptr) noexcept
+        [[nodiscard]] LOGGER_EXPORT bool isTraceEnabled(std::uint64_t trace_id) noexcept;
+
+        /**
+        * \brief Check if the calling thread works on a trace whose records are all logged
+        */
+        [[nodiscard]] inline bool isTraced() noexcept
         {
-            return {ptr};
+            const auto trace_id = currentTraceId();
+            return trace_id != 0 && isTraceEnabled(trace_id);
         }
 
         /**
-        * \brief Get the string representation of a C-style string
-        * 
-        * \param ptr A C-style string
-        * \return std::string That same string, but better
+        * \brief Decide if a record with level is logged to channel: it has to pass the minimum log level and the sample rate,
+        * unless the calling thread works on an enabled trace. Called before any argument is formatted
         */
-        template <>
-        [[nodiscard]] inline std::string getRepStreamable<char, void>(char* ptr) noexcept
+        [[nodiscard]] inline bool shouldLog(const ChannelState& channel, LogLevel level) noexcept
         {
-            return {ptr};
+            return (isEnabled(channel, level) && isSampled(channel, level)) || isTraced();
         }
 
         /**
-        * \brief Print an object that can be converted using streams
+        * \brief Count a record that did not pass the minimum log level. Only touches counters of the calling thread
+        */
+        LOGGER_EXPORT void countFiltered(LogLevel level) noexcept;
+
+        /**
+        * \brief Lock the output stream so logging is thread-safe
+        */
+        LOGGER_EXPORT void lockStream();
+
+        /**
+        * \brief Unlock the output stream so logging is thread-safe
+        */
+        LOGGER_EXPORT void unlockStream() noexcept;
+
+        /**
+        * \brief Position and color state of a record that is being assembled in a message buffer
+        */
+        struct RecordMarker
+        {
+            std::size_t start;
+            LogLevel level;
+            std::size_t color_size;
+            SinkRegistry* sinks;
+            RecordFormat format;
+            std::size_t message_start; //where the message starts in logfmt and json records
+            std::size_t fields_start;  //in structuredFields()
+        };
+
+        /**
+        * \brief Start a new record at the end of buffer by appending the color sequence and [LABEL] prefix. The color is
+        * always added, sinks without color skip it. Labels and colors are read from an immutable snapshot, so no lock is taken
         * 
-        * \tparam T Type of the object
-        * \param log_with_label If the object should be logged with [LABEL] in front of it
-        * \param obj Object to log
+        * \param buffer Buffer the record is assembled in
+        * \param channel Channel whose sinks the record is written to
+        * \param level Level of the record
+        * \param with_label If the record should start with [LABEL]
+        * \return RecordMarker Marker that has to be passed to endRecord()
         */
-        template <typename T, std::enable_if_t<details::is_to_stream_writable_v<std::ostringstream, T>, bool> = true>
-        void logObj(bool log_with_label, T&& obj) noexcept
+        [[nodiscard]] LOGGER_EXPORT RecordMarker
+        beginRecord(std::string& buffer, const ChannelState& channel, LogLevel level, bool with_label) noexcept;
+
+        /**
+        * \brief Time a record was logged. Keeps the format it was taken in, the format may change before it is printed
+        */
+        struct RecordTimestamp
         {
-            std::string representation = getRepStreamable(std::forward<T>(obj));
+            std::uint64_t nanoseconds{0}; //steady clock for raw, system clock otherwise, 0 for none
+            TimestampFormat format{TimestampFormat::none};
+        };
 
-            if (log_with_label) {
-                print(representation);
-            } else {
-                printWithoutLabel(representation);
-            }
-        }
+        /**
+        * \brief Take a timestamp in the current TimestampFormat
+        */
+        [[nodiscard]] LOGGER_EXPORT RecordTimestamp timestampNow() noexcept;
+
+        /**
+        * \brief Like beginRecord(), but with a timestamp that was taken earlier by timestampNow()
+        */
+        [[nodiscard]] LOGGER_EXPORT RecordMarker beginRecordAt(
+            std::string& buffer, const ChannelState& channel, LogLevel level, bool with_label,
+            RecordTimestamp timestamp) noexcept;
 
         /**
-        * \brief Print an object that cannot be converted using streams
+        * \brief Finish the record started at marker, hand it to the output (or the thread buffer) in a single write and remove it from buffer
         * 
-        * \tparam T Type of the object
-        * \param log_with_label If the object should be logged with [LABEL] in front of it
-        * \param obj Object to log
+        * \param buffer Buffer the record was assembled in
+        * \param marker Marker returned by beginRecord()
         */
-        template <typename T, std::enable_if_t<!details::is_to_stream_writable_v<std::ostringstream, T>, bool> = false>
-        void logObj(bool log_with_label, T&& obj) noexcept
+        LOGGER_EXPORT void endRecord(std::string& buffer, RecordMarker marker);
+
+        /**
+        * \brief Log args in a thread safe way without checking the level. Callers decide with shouldLog() first
+        */
+        template <typename T, typename... Args>
+        void logUnchecked(ChannelState& channel, LogLevel level, bool log_with_label, T&& obj, Args&&... args)
         {
-            std::string representation = getRepNonStreamable(std::forward<T>(obj));
+            //only falls through to formatting the record here if binary logging was disabled while encoding it.
+            //FATAL records are never deferred, they are flushed before the call returns
+            if (level != LogLevel::fatal && details::binaryLoggingEnabled() &&
+                details::logBinary(channel, level, log_with_label, std::forward<T>(obj), std::forward<Args>(args)...)) {
+                return;
+            }
+
+            //nested log calls (e.g. from inside an operator<<) assemble their record behind the one of the outer call
+            auto& buffer = messageBuffer();
+            const auto marker = beginRecord(buffer, channel, level, log_with_label);
 
-            if (log_with_label) {
-                print(representation);
+            if constexpr (is_format_string_v<T>) {
+                appendFormatted<std::remove_cv_t<std::remove_reference_t<T>>>(buffer, std::forward<Args>(args)...);
             } else {
-                printWithoutLabel(representation);
+                formatArg(buffer, std::forward<T>(obj));
+                (formatArg(buffer, std::forward<Args>(args)), ...);
             }
+
+            endRecord(buffer, marker);
         }
 
         /**
@@ -202,23 +339,32 @@ namespace Logger {
         * 
         * \tparam T Type of the first object
         * \tparam Args Type of the other objects
+        * \param channel Channel used for checking the level and responsible for the sinks
         * \param level Level used for checking if the objects should be logged at all and responsible for the label
-        * \param log_with_label If the first object should be logged with [LABEL] in front of it
+        * \param log_with_label If the message should be logged with [LABEL] in front of it
         * \param obj First object to log
         * \param args Rest of the objects to log
         */
         template <typename T, typename... Args>
-        void logConcurrent(LogLevel level, bool log_with_label, T&& obj, Args&&... args)
+        void logConcurrent(ChannelState& channel, LogLevel level, bool log_with_label, T&& obj, Args&&... args)
         {
-            RAYCHELLOGGER_LOCK_STREAM();
-
-            if (level < details::requiredLevel() && level != LogLevel::fatal) { //fatal messages cannot be blocked
+            //checked before locking so filtered messages never touch the mutex
+            if (!details::shouldLog(channel, level)) {
+                if constexpr (RAYCHELLOGGER_COUNT_FILTERED) {
+                    details::countFiltered(level);
+                }
                 return;
             }
+            logUnchecked(channel, level, log_with_label, std::forward<T>(obj), std::forward<Args>(args)...);
+        }
 
-            setLogLevel(level);
-            logObj(log_with_label, std::forward<T>(obj));
-            (logObj(false, std::forward<Args>(args)), ...);
+        /**
+        * \brief Log args to the default channel in a thread safe way
+        */
+        template <typename T, typename... Args>
+        void logConcurrent(LogLevel level, bool log_with_label, T&& obj, Args&&... args)
+        {
+            logConcurrent(defaultChannelState(), level, log_with_label, std::forward<T>(obj), std::forward<Args>(args)...);
         }
 
         /**
@@ -244,7 +390,9 @@ namespace Logger {
     template <typename... Args>
     void log(LogLevel level, Args&&... args)
     {
-        details::logConcurrent(level, true, std::forward<Args>(args)...);
+        if (details::isCompiledIn(level)) {
+            details::logConcurrent(level, true, std::forward<Args>(args)...);
+        }
     }
 
     /// \brief Log a message with the DEBUG level. Can log multiple objects seperated by comma
@@ -253,7 +401,9 @@ namespace Logger {
     template <typename... Args>
     void debug(Args&&... args)
     {
-        details::logConcurrent(LogLevel::debug, true, std::forward<Args>(args)...);
+        if constexpr (details::isCompiledIn(LogLevel::debug)) {
+            details::logConcurrent(LogLevel::debug, true, std::forward<Args>(args)...);
+        }
     }
 
     /// \brief Log a message with the INFO level. Can log multiple objects seperated by comma
@@ -262,7 +412,9 @@ namespace Logger {
     template <typename... Args>
     void info(Args&&... args)
     {
-        details::logConcurrent(LogLevel::info, true, std::forward<Args>(args)...);
+        if constexpr (details::isCompiledIn(LogLevel::info)) {
+            details::logConcurrent(LogLevel::info, true, std::forward<Args>(args)...);
+        }
     }
 
     /// \brief Log a message with the WARN level. Can log multiple objects seperated by comma
@@ -271,7 +423,9 @@ namespace Logger {
     template <typename... Args>
     void warn(Args&&... args)
     {
-        details::logConcurrent(LogLevel::warn, true, std::forward<Args>(args)...);
+        if constexpr (details::isCompiledIn(LogLevel::warn)) {
+            details::logConcurrent(LogLevel::warn, true, std::forward<Args>(args)...);
+        }
     }
 
     /// \brief Log a message with the ERROR level. Can log multiple objects seperated by comma
@@ -280,7 +434,9 @@ namespace Logger {
     template <typename... Args>
     void error(Args&&... args)
     {
-        details::logConcurrent(LogLevel::error, true, std::forward<Args>(args)...);
+        if constexpr (details::isCompiledIn(LogLevel::error)) {
+            details::logConcurrent(LogLevel::error, true, std::forward<Args>(args)...);
+        }
     }
 
     /// \brief Log a message with the ERROR level. Can log multiple objects seperated by comma
@@ -289,16 +445,20 @@ namespace Logger {
     template <typename... Args>
     void critical(Args&&... args)
     {
-        details::logConcurrent(LogLevel::critical, true, std::forward<Args>(args)...);
+        if constexpr (details::isCompiledIn(LogLevel::critical)) {
+            details::logConcurrent(LogLevel::critical, true, std::forward<Args>(args)...);
+        }
     }
 
-    /// \brief Log a message with the FATAL level. Can log multiple objects seperated by comma
+    /// \brief Log a message with the FATAL level. Can log multiple objects seperated by comma. Everything buffered is flushed before it returns
     /// \tparam ...Args Types of the objects to be logged
     /// \param ...args Objects to be logged
     template <typename... Args>
     void fatal(Args&&... args)
     {
-        details::logConcurrent(LogLevel::fatal, true, std::forward<Args>(args)...);
+        if constexpr (details::isCompiledIn(LogLevel::fatal)) {
+            details::logConcurrent(LogLevel::fatal, true, std::forward<Args>(args)...);
+        }
     }
 
     /// \brief Log a message regardless of the minimum required log level. Can log multiple objects seperated by a comma.
@@ -311,7 +471,7 @@ namespace Logger {
     }
 
     /**
-    * \brief Set the label for a specific log level
+    * \brief Set the label for a specific log level. Records that are being assembled right now keep the old label
     * 
     * \param level Level for the label
     * \param label Label for the level
@@ -319,7 +479,7 @@ namespace Logger {
     LOGGER_EXPORT void setLogLabel(LogLevel level, std::string_view label) noexcept;
 
     /**
-    * \brief Set the color escape sequence for a specific log level
+    * \brief Set the color escape sequence for a specific log level. Records that are being assembled right now keep the old color
     * 
     * \param level Level for the color seqeuence
     * \param color_escape_sequence color sequence for the level
@@ -327,24 +487,172 @@ namespace Logger {
     LOGGER_EXPORT void setLogColor(LogLevel level, std::string_view color_escape_sequence) noexcept;
 
     /**
-    * \brief Set the output stream for all logging operations
+    * \brief Put a timestamp in front of every record. The date and time are in local time and only formatted once per
+    * second and thread, later records in the same second only append their fraction of a second. Disabled by default
+    * 
+    * \param format Precision of the timestamp, or raw steady clock nanoseconds
+    */
+    LOGGER_EXPORT void setTimestampFormat(TimestampFormat format) noexcept;
+
+    /**
+    * \brief Set the layout of all records. Messages and string values are escaped as required by the format, numbers and
+    * booleans are written as they are. Text by default
+    * 
+    * \param format New layout
+    */
+    LOGGER_EXPORT void setRecordFormat(RecordFormat format) noexcept;
+
+    /**
+    * \brief Create a key-value pair that is logged as a field of the record instead of being appended to the message,
+    * e.g. info("request done", kv("id", id), kv("ms", ms)). Numbers are kept as numbers, also in binary mode
+    * 
+    * \param key Name of the field. Has to live until the record is logged
+    * \param value Value of the field. Formatted like any other argument
+    */
+    template <typename T>
+    [[nodiscard]] auto kv(std::string_view key, const T& value) noexcept
+    {
+        if constexpr (std::is_array_v<T>) {
+            return details::KeyValue<const std::remove_extent_t<T>*>{key, value};
+        } else {
+            return details::KeyValue<const T&>{key, value};
+        }
+    }
+
+    /**
+    * \brief Set the output stream for all logging operations. Safe while other threads log, they are never blocked by it
     * 
     * \param new_out_stream new output stream
     */
     LOGGER_EXPORT void setOutStream(std::ostream& new_out_stream);
 
     /**
-    * \brief Disable colored output
+    * \brief Hand all log records to a background writer thread instead of writing them on the calling thread.
+    * Records are passed through a lock-free queue whose slots are allocated up front. If asynchronous mode is already
+    * enabled, the old queue is drained and replaced
+    * 
+    * \param queue_capacity Maximum number of records waiting to be written. Rounded up to a power of two
+    * \param policy What to do with new records while the queue is full
+    */
+    LOGGER_EXPORT void enableAsync(std::size_t queue_capacity = 8192, OverflowPolicy policy = OverflowPolicy::block);
+
+    /**
+    * \brief Write all queued records, stop the background writer thread and go back to writing on the calling thread
+    */
+    LOGGER_EXPORT void disableAsync() noexcept;
+
+    /**
+    * \brief Collect the records of every thread in a buffer owned by that thread and only write them once the buffer is full
+    * or flush_interval has passed. Records of one thread are always written in the order they were logged, records of
+    * different threads are only ordered relative to each other per flushed batch
+    * 
+    * \param buffer_size Number of bytes a thread may collect before its buffer is written
+    * \param flush_interval Maximum time a record may wait in a thread buffer
+    */
+    LOGGER_EXPORT void enableThreadBuffering(
+        std::size_t buffer_size = 64 * 1024, std::chrono::milliseconds flush_interval = std::chrono::milliseconds{100});
+
+    /**
+    * \brief Write the buffers of all threads and go back to writing every record immediately
+    */
+    LOGGER_EXPORT void disableThreadBuffering() noexcept;
+
+    /**
+    * \brief Copy the arguments of every record into a ring buffer owned by the logging thread and format them on a background
+    * thread instead. Numbers and pointers are formatted by the background thread, strings are copied and objects with an
+    * operator<< are still formatted by the logging thread. Records of one thread are written in the order they were logged
+    * 
+    * \param ring_size Size of the ring buffer of each thread in bytes. Rounded up to a power of two
+    */
+    LOGGER_EXPORT void enableBinaryLogging(std::size_t ring_size = std::size_t{1} << 20U);
+
+    /**
+    * \brief Format every outstanding binary record and go back to formatting records on the logging thread
+    */
+    LOGGER_EXPORT void disableBinaryLogging() noexcept;
+
+    /**
+    * \brief Get the number of records that were discarded because the asynchronous queue was full or out of memory
+    * 
+    * \return std::size_t Number of dropped records since the start of the program
+    */
+    [[nodiscard]] LOGGER_EXPORT std::size_t droppedRecords() noexcept;
+
+    /**
+    * \brief Disable colored output of the primary sink
     */
     LOGGER_EXPORT void disableColor() noexcept;
 
     /**
-    * \brief Enable colored output
+    * \brief Enable colored output of the primary sink
     */
     LOGGER_EXPORT void enableColor() noexcept;
 
     /**
-    * \brief Start a new timer and associate it with the label. If the label already exists, the timer will be overriden
+    * \brief Handle to a running timer. The start time lives in the handle itself, so starting and ending these timers
+    * never locks and never allocates. Handles can be copied and ended as often as needed
+    */
+    struct TimerHandle
+    {
+        timePoint_t start;
+    };
+
+    /**
+    * \brief Start a new timer that is not associated with a label
+    * 
+    * \return TimerHandle Handle for endTimer()
+    */
+    [[nodiscard]] inline TimerHandle startTimer() noexcept
+    {
+        return TimerHandle{std::chrono::high_resolution_clock::now()};
+    }
+
+    /**
+    * \brief Get the time since timer was started
+    * 
+    * \tparam T Type of duration returned
+    * \param timer Handle returned by startTimer()
+    * \return T Duration since the timer started. Truncated to the precision of T
+    */
+    template <typename T = std::chrono::milliseconds>
+    [[nodiscard]] T endTimer(TimerHandle timer) noexcept
+    {
+        return std::chrono::duration_cast<T>(std::chrono::high_resolution_clock::now() - timer.start);
+    }
+
+    /**
+    * \brief Log the time since timer was started
+    * 
+    * \tparam T Type of duration used
+    * \param level Level used for logging the duration
+    * \param timer Handle returned by startTimer()
+    * \param prefix Prefix that is logged before the duration. The format will be [LEVEL] {prefix}{duration}{suffix} '\n'
+    * \param suffix Optional suffix that is logged after the duration. The default is chosen based on the duration Type (nanoseconds => "ns" microseconds => "us" etc.)
+    */
+    template <typename T>
+    void logDuration(
+        LogLevel level, TimerHandle timer, std::string_view prefix, std::string_view suffix = details::suffix_for<T>::value) noexcept
+    {
+        log(level, prefix, endTimer<T>(timer).count(), suffix, '\n');
+    }
+
+    /**
+    * \brief Log the time since timer was started with the LOG level
+    * 
+    * \tparam T Type of duration used
+    * \param timer Handle returned by startTimer()
+    * \param prefix Prefix that is logged before the duration. The format will be [LEVEL] {prefix}{duration}{suffix} '\n'
+    * \param suffix Optional suffix that is logged after the duration. The default is chosen based on the duration Type (nanoseconds => "ns" microseconds => "us" etc.)
+    */
+    template <typename T = std::chrono::milliseconds>
+    void logDuration(TimerHandle timer, std::string_view prefix, std::string_view suffix = details::suffix_for<T>::value) noexcept
+    {
+        logDuration<T>(LogLevel::log, timer, prefix, suffix);
+    }
+
+    /**
+    * \brief Start a new timer and associate it with the label. If the label already exists, the timer will be overriden.
+    * Labeled timers are stored in a map behind a lock, prefer the TimerHandle overloads for hot code
     * 
     * \param label label for the new timer
     * \return std::string the new label
@@ -474,19 +782,300 @@ namespace Logger {
     */
     LOGGER_EXPORT LogLevel setMinimumLogLevel(LogLevel) noexcept;
 
+    /**
+    * \brief Keep only 1 in one_in records with level that pass the minimum log level, picked at random. Records that are
+    * dropped are never formatted. 0 and 1 keep all records, FATAL records are never sampled
+    */
+    LOGGER_EXPORT void setSampleRate(LogLevel level, std::uint32_t one_in) noexcept;
+
+    /**
+    * \brief Log every record of threads working on trace_id, regardless of the minimum log level and the sample rates.
+    * RAYCHELLOGGER_COMPILE_LEVEL still applies. Throws std::bad_alloc if there is no memory for another trace
+    */
+    LOGGER_EXPORT void enableTrace(std::uint64_t trace_id);
+
+    /**
+    * \brief Undo enableTrace(). Returns false if trace_id was not enabled. Throws std::bad_alloc if there is no memory
+    */
+    LOGGER_EXPORT bool disableTrace(std::uint64_t trace_id);
+
+    /**
+    * \brief Set the ID of the trace (e.g. the request) the calling thread works on. 0 means none
+    *
+    * \return std::uint64_t The previous trace ID of this thread
+    */
+    inline std::uint64_t setTraceId(std::uint64_t trace_id) noexcept
+    {
+        return std::exchange(details::currentTraceId(), trace_id);
+    }
+
+    /**
+    * \brief Sets the trace ID of the calling thread while it is alive and restores the previous one afterwards
+    */
+    class TraceScope
+    {
+    public:
+        explicit TraceScope(std::uint64_t trace_id) noexcept : previous_{setTraceId(trace_id)}
+        {}
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope(TraceScope&&) = delete;
+
+        TraceScope& operator=(const TraceScope&) = delete;
+        TraceScope& operator=(TraceScope&&) = delete;
+
+        ~TraceScope() noexcept
+        {
+            setTraceId(previous_);
+        }
+
+    private:
+        std::uint64_t previous_;
+    };
+
+    /**
+    * \brief When the buffer of a log file is handed to the operating system. It is always flushed when it is full
+    */
+    struct FlushPolicy
+    {
+        ///Flush after every record
+        bool every_record{false};
+
+        ///Flush after a record with at least this level. LOG records never trigger this, so LogLevel::log disables it
+        LogLevel min_level{LogLevel::error};
+
+        ///Flush once at least this many bytes are buffered. 0 disables this
+        std::size_t every_bytes{0};
+
+        ///Flush at least this often. 0 disables this
+        std::chrono::milliseconds interval{0};
+    };
+
+    /**
+    * \brief When a log file is rotated. The current file {name} is renamed to {name}.1, older files move up one number
+    * and files beyond max_files are deleted. Renaming and opening happens on a background thread, records that are
+    * logged in the meantime are kept in the buffer of the log file
+    */
+    struct RotationPolicy
+    {
+        ///Rotate once the current file is at least this many bytes long. 0 disables this
+        std::size_t max_size{0};
+
+        ///Rotate once the current file is this old. 0 disables this
+        std::chrono::seconds interval{0};
+
+        ///Number of rotated files that are kept
+        std::size_t max_files{5};
+
+        ///Compress rotated files to {name}.N.gz. Ignored if RaychelLogger was built without zlib
+        bool compress{false};
+    };
+
+    /**
+    * \brief Options for log files
+    */
+    struct FileSinkOptions
+    {
+        ///Number of bytes that are collected before the log file is written
+        std::size_t buffer_size{256 * 1024};
+
+        FlushPolicy flush{};
+
+        RotationPolicy rotation{};
+
+        ///Write the log file through a memory mapping instead of a buffer. buffer_size and flush are ignored, the file is rotated once it is full
+        bool memory_mapped{false};
+
+        ///Size of every memory mapped log file. The part that was not written to is cut off when the file is closed
+        std::size_t mapped_size{64 * 1024 * 1024};
+    };
+
     /**
     * \brief Initialize a new log file.
     * 
     * \param directory Name of the directory for the log file
     * \param fileName Name of the log file. "Log.log" by default
-    * \return LOGGER_EXPORT 
+    * \param options Buffer size and flush policy of the log file
     */
-    LOGGER_EXPORT void initLogFile(std::string_view directory, std::string_view fileName = "Log.log");
+    LOGGER_EXPORT void initLogFile(
+        std::string_view directory, std::string_view fileName = "Log.log", const FileSinkOptions& options = {});
 
     /**
-    * \brief If existent, save the current log file to disk and close it.
+    * \brief Write everything that is still buffered (thread buffers, the asynchronous queue and the log file) to the output
+    */
+    LOGGER_EXPORT void flush() noexcept;
+
+    /**
+    * \brief If existent, save the current log file to disk and close it. Records still waiting in the asynchronous queue are written first
     */
     LOGGER_EXPORT void dumpLogFile() noexcept;
+
+    /**
+    * \brief Install handlers for SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT and std::terminate that write out buffered records
+    * before the process goes down. Log file buffers are appended to their files, records still waiting in the asynchronous
+    * queue or in thread buffers go to the log file opened by initLogFile(), or stderr if there is none. Only async-signal-safe
+    * calls are used, no lock is taken. The previous handlers run afterwards. Calling it more than once does nothing.
+    * The handlers run on an alternate signal stack, which is set up for the calling thread, so a stack overflow in that thread
+    * is written out as well
+    */
+    LOGGER_EXPORT void installCrashHandler() noexcept;
+
+    /**
+    * \brief What the logger itself did since the program started. Counters are kept per thread and only added up by stats()
+    */
+    struct LoggerStats
+    {
+        ///Records handed to the sinks, indexed by LogLevel
+        std::array<std::uint64_t, static_cast<std::size_t>(LogLevel::log) + 1> emitted{};
+
+        ///Records that did not pass the minimum log level or the sample rate of their channel, indexed by LogLevel. Always 0
+        ///unless the program is compiled with RAYCHELLOGGER_COUNT_FILTERED=1
+        std::array<std::uint64_t, static_cast<std::size_t>(LogLevel::log) + 1> filtered{};
+
+        ///Bytes written to sinks. A record written to two sinks counts twice
+        std::uint64_t bytes_written{0};
+
+        ///How often a thread had to wait for the output lock or the lock of a channel's sinks, and for how long in total
+        std::uint64_t lock_contentions{0};
+        std::chrono::nanoseconds lock_wait_time{0};
+
+        ///Records in the asynchronous queue right now and the most there have been since it was enabled
+        std::uint64_t queue_depth{0};
+        std::uint64_t queue_high_water{0};
+
+        ///Records the asynchronous queue discarded because it was full or had no memory for a long record
+        std::uint64_t dropped{0};
+
+        ///Records network sinks discarded because their buffer was full or the collector could not be reached in time
+        std::uint64_t network_dropped{0};
+
+        ///Binary records the decoder could not decode because their call site was unknown
+        std::uint64_t binary_dropped{0};
+
+        ///How often a log file buffer or stream was flushed, and how long that took in total
+        std::uint64_t flushes{0};
+        std::chrono::nanoseconds flush_time{0};
+
+        ///Records log files discarded because the file could not be opened again after a rotation or was too small for them
+        std::uint64_t file_dropped{0};
+
+        ///Renames, removals and compressions of rotated log files that failed. The files involved are left as they were
+        std::uint64_t file_errors{0};
+    };
+
+    /**
+    * \brief Add up the counters of all threads
+    */
+    [[nodiscard]] LOGGER_EXPORT LoggerStats stats() noexcept;
+
+    using SinkId = std::size_t;
+
+    ///The sink controlled by setOutStream(), initLogFile() and enableColor()/disableColor()
+    constexpr SinkId primary_sink = 0;
+
+    /**
+    * \brief Turns a record into what a sink writes. Every record is formatted only once, so a formatter can only decorate it
+    * 
+    * \param out Buffer to append the output to. Always empty when the formatter is called
+    * \param level Level of the record
+    * \param record The record without color sequences, including its [LABEL] prefix
+    */
+    using RecordFormatter = void (*)(std::string& out, LogLevel level, std::string_view record) noexcept;
+
+    /**
+    * \brief Options of a single sink
+    */
+    struct SinkOptions
+    {
+        ///Records below this level are not written to the sink. The minimum log level still applies to all sinks
+        LogLevel min_level{LogLevel::debug};
+
+        bool color{false};
+
+        ///Written instead of the record if set. Overrides color
+        RecordFormatter formatter{nullptr};
+    };
+
+    /**
+    * \brief Write every record to os as well. os must outlive the sink
+    * 
+    * \return SinkId ID for removeSink() and setSinkOptions()
+    */
+    LOGGER_EXPORT SinkId addSink(std::ostream& os, const SinkOptions& options = {});
+
+    /**
+    * \brief Write every record to a new log file as well
+    * 
+    * \param directory Name of the directory for the log file
+    * \param fileName Name of the log file
+    * \param options Level, color and formatter of the sink
+    * \param file_options Buffer size, flush and rotation policy of the log file
+    * \return std::optional<SinkId> ID for removeSink() and setSinkOptions(). Empty if the file could not be opened
+    */
+    LOGGER_EXPORT std::optional<SinkId> addFileSink(
+        std::string_view directory, std::string_view fileName, const SinkOptions& options = {},
+        const FileSinkOptions& file_options = {});
+
+    /// \brief Transport of a network sink
+    enum class NetworkProtocol { udp, tcp };
+
+    /**
+    * \brief Options for network sinks. Records are collected in a buffer and sent by a background thread, so logging never
+    * waits for the network. The thread connects, reconnects after errors and keeps records while the collector is down
+    */
+    struct NetworkSinkOptions
+    {
+        ///UDP sends every record as its own datagram, TCP sends the buffer as one stream
+        NetworkProtocol protocol{NetworkProtocol::udp};
+
+        ///Send every record as an RFC 5424 syslog message without a timestamp. Over TCP, messages are octet-counted (RFC 6587)
+        bool syslog{false};
+
+        ///APP-NAME of syslog messages
+        std::string app_name{"-"};
+
+        ///Bytes kept while they cannot be sent. Records that do not fit are discarded and counted in LoggerStats::network_dropped
+        std::size_t buffer_size{4 * 1024 * 1024};
+
+        ///Records are sent once this many bytes are buffered, or after send_interval
+        std::size_t batch_size{64 * 1024};
+        std::chrono::milliseconds send_interval{100};
+
+        ///Time to wait before the first reconnect. Doubled after every failed attempt, up to max_backoff
+        std::chrono::milliseconds min_backoff{100};
+        std::chrono::milliseconds max_backoff{30 * 1000};
+
+        ///How long removing the sink waits for the records that are still buffered to be sent
+        std::chrono::milliseconds close_timeout{1000};
+    };
+
+    /**
+    * \brief Send every record to a log collector as well
+    * 
+    * \param host Name or address of the collector
+    * \param port Port of the collector
+    * \param options Level, color and formatter of the sink
+    * \param network_options Protocol, framing, buffering and reconnect policy
+    * \return std::optional<SinkId> ID for removeSink() and setSinkOptions(). Empty if this platform has no sockets
+    */
+    LOGGER_EXPORT std::optional<SinkId> addNetworkSink(
+        std::string_view host, std::uint16_t port, const SinkOptions& options = {},
+        const NetworkSinkOptions& network_options = {});
+
+    /**
+    * \brief Stop writing to a sink. Records that are still buffered are written to it first. The primary sink cannot be removed
+    * 
+    * \return true if the sink existed
+    */
+    LOGGER_EXPORT bool removeSink(SinkId id);
+
+    /**
+    * \brief Replace the options of a sink. Safe while other threads log, records that are being written right now may still
+    * use the old options
+    * 
+    * \return true if the sink exists
+    */
+    LOGGER_EXPORT bool setSinkOptions(SinkId id, const SinkOptions& options) noexcept;
 } // namespace Logger
 
 #endif /* LOGGER_H_ */
@@ -0,0 +1,187 @@
+/**
+*\file RateLimit.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Rate limiting and sampling of individual log sites
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef RATELIMIT_H_
+#define RATELIMIT_H_
+
+#include "Logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//All of these macros keep their state in a static variable, so every use is its own log site. Throttled calls skip the
+//formatting of their arguments entirely, just like RAYCHELLOGGER_LOG. Like there, level may be chosen at runtime.
+//A record first has to pass shouldLog() like any other record, records that do not are counted as filtered. Only the
+//ones that do count towards the limit of the site. Records of threads working on an enabled trace are never throttled
+
+//Runs the statement after it if the record passes the minimum log level and admit is true. Used by the macros below, which
+//pass the level they already evaluated
+#define RAYCHELLOGGER_DETAIL_THROTTLED(level, admit)                                                                             \
+    if (auto& raychellogger_state_ = ::Logger::details::defaultChannelState();                                                   \
+        !::Logger::details::shouldLog(raychellogger_state_, level)) {                                                            \
+        if constexpr (RAYCHELLOGGER_COUNT_FILTERED) {                                                                            \
+            ::Logger::details::countFiltered(level);                                                                             \
+        }                                                                                                                        \
+    } else if (::Logger::details::isTraced() || (admit))
+
+//Log the 1st, (n+1)th, (2n+1)th... record of this site. n of 0 and 1 log every record
+#define RAYCHELLOGGER_LOG_EVERY_N(level, n, ...)                                                                                 \
+    do {                                                                                                                         \
+        const auto raychellogger_level_ = (level);                                                                               \
+        if (::Logger::details::isCompiledIn(raychellogger_level_)) {                                                             \
+            static std::atomic<std::size_t> raychellogger_counter_{0};                                                           \
+            const auto raychellogger_n_ = static_cast<std::size_t>(n);                                                           \
+            RAYCHELLOGGER_DETAIL_THROTTLED(raychellogger_level_,                                                                 \
+                raychellogger_n_ <= 1 ||                                                                                         \
+                raychellogger_counter_.fetch_add(1, std::memory_order_relaxed) % raychellogger_n_ == 0) {                        \
+                ::Logger::details::logUnchecked(raychellogger_state_, raychellogger_level_, true, __VA_ARGS__);                  \
+            }                                                                                                                    \
+        }                                                                                                                        \
+    } while (false)
+
+//Log only the first n records of this site
+#define RAYCHELLOGGER_LOG_FIRST_N(level, n, ...)                                                                                 \
+    do {                                                                                                                         \
+        const auto raychellogger_level_ = (level);                                                                               \
+        if (::Logger::details::isCompiledIn(raychellogger_level_)) {                                                             \
+            static std::atomic<std::size_t> raychellogger_counter_{0};                                                           \
+            const auto raychellogger_n_ = static_cast<std::size_t>(n);                                                           \
+            RAYCHELLOGGER_DETAIL_THROTTLED(raychellogger_level_,                                                                 \
+                raychellogger_counter_.load(std::memory_order_relaxed) < raychellogger_n_ &&                                     \
+                raychellogger_counter_.fetch_add(1, std::memory_order_relaxed) < raychellogger_n_) {                             \
+                ::Logger::details::logUnchecked(raychellogger_state_, raychellogger_level_, true, __VA_ARGS__);                  \
+            }                                                                                                                    \
+        }                                                                                                                        \
+    } while (false)
+
+//Log 1 in n records of this site on average, picked at random, on top of the sample rate of the level. Unlike
+//RAYCHELLOGGER_LOG_EVERY_N, threads logging from the same site share no counter
+#define RAYCHELLOGGER_LOG_SAMPLED(level, n, ...)                                                                                 \
+    do {                                                                                                                         \
+        const auto raychellogger_level_ = (level);                                                                               \
+        if (::Logger::details::isCompiledIn(raychellogger_level_)) {                                                             \
+            RAYCHELLOGGER_DETAIL_THROTTLED(raychellogger_level_,                                                                 \
+                ::Logger::details::sampleOneIn(static_cast<std::uint32_t>(n))) {                                                 \
+                ::Logger::details::logUnchecked(raychellogger_state_, raychellogger_level_, true, __VA_ARGS__);                  \
+            }                                                                                                                    \
+        }                                                                                                                        \
+    } while (false)
+
+//Log at most max_records records of this site per interval. max_records of 0 logs nothing
+#define RAYCHELLOGGER_LOG_RATE_LIMITED(level, max_records, interval, ...)                                                        \
+    do {                                                                                                                         \
+        const auto raychellogger_level_ = (level);                                                                               \
+        if (::Logger::details::isCompiledIn(raychellogger_level_)) {                                                             \
+            static ::Logger::RateLimiter raychellogger_limiter_{max_records, interval};                                          \
+            RAYCHELLOGGER_DETAIL_THROTTLED(raychellogger_level_, raychellogger_limiter_.tryAcquire()) {                          \
+                ::Logger::details::logUnchecked(raychellogger_state_, raychellogger_level_, true, __VA_ARGS__);                  \
+            }                                                                                                                    \
+        }                                                                                                                        \
+    } while (false)
+
+//Log at most one record of this site per interval. The next record that is logged is preceded by the number of records
+//that were suppressed in between
+#define RAYCHELLOGGER_LOG_COLLAPSED(level, interval, ...)                                                                        \
+    do {                                                                                                                         \
+        const auto raychellogger_level_ = (level);                                                                               \
+        if (::Logger::details::isCompiledIn(raychellogger_level_)) {                                                             \
+            static ::Logger::RateLimiter raychellogger_limiter_{1, interval};                                                    \
+            RAYCHELLOGGER_DETAIL_THROTTLED(raychellogger_level_, raychellogger_limiter_.tryAcquire()) {                          \
+                const auto raychellogger_repeated_ = raychellogger_limiter_.takeSuppressed();                                    \
+                if (raychellogger_repeated_ != 0) {                                                                              \
+                    ::Logger::details::logUnchecked(raychellogger_state_,                                                        \
+                        raychellogger_level_,                                                                                    \
+                        true,                                                                                                    \
+                        "previous message repeated ",                                                                            \
+                        raychellogger_repeated_,                                                                                 \
+                        " times\n");                                                                                             \
+                }                                                                                                                \
+                ::Logger::details::logUnchecked(raychellogger_state_, raychellogger_level_, true, __VA_ARGS__);                  \
+            }                                                                                                                    \
+        }                                                                                                                        \
+    } while (false)
+
+namespace Logger {
+
+    /**
+    * \brief Lets at most max_records calls through per interval. The window and the number of calls in it share one
+    * atomic, so checking never locks
+    */
+    class RateLimiter
+    {
+    public:
+        template <typename Rep, typename Period>
+        constexpr RateLimiter(std::uint32_t max_records, std::chrono::duration<Rep, Period> interval) noexcept
+            : maxRecords_{max_records}, interval_{std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()}
+        {}
+
+        /**
+        * \brief Check if another call may pass in the current interval. Rejected calls are counted
+        */
+        [[nodiscard]] bool tryAcquire() noexcept
+        {
+            const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+            const auto window = static_cast<std::uint32_t>(now.count() / (interval_ > 0 ? interval_ : 1));
+
+            auto state = state_.load(std::memory_order_relaxed);
+            while (true) {
+                const auto current_window = static_cast<std::uint32_t>(state >> 32U);
+
+                //a new window starts with no calls, it is still subject to the limit (which may be 0)
+                const auto count = current_window == window ? static_cast<std::uint32_t>(state) : 0U;
+                if (count >= maxRecords_) {
+                    suppressed_.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                const auto next = (std::uint64_t{window} << 32U) | (count + 1U);
+
+                if (state_.compare_exchange_weak(state, next, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+
+        /**
+        * \brief Get the number of rejected calls since the last call to this function
+        */
+        [[nodiscard]] std::size_t takeSuppressed() noexcept
+        {
+            return suppressed_.exchange(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::uint32_t maxRecords_;
+        std::int64_t interval_;
+
+        std::atomic<std::uint64_t> state_{0}; //interval number in the upper half, calls in that interval in the lower half
+        std::atomic<std::size_t> suppressed_{0};
+    };
+
+} // namespace Logger
+
+#endif /* RATELIMIT_H_ */
@@ -0,0 +1,450 @@
+/**
+*\file BinaryLog.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Ring buffers and decoder thread of the binary log mode
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+
+#include "BinaryLog.h"
+#include "Stats.h"
+
+#include "RaychelLogger/Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Logger::details {
+
+    struct BinaryRecordHeader
+    {
+        std::uint32_t site;
+        std::uint32_t size; //size of the payload
+        std::uint32_t level;
+        std::uint32_t with_label;
+        const ChannelState* channel;
+        RecordTimestamp timestamp; //taken when the record was logged, not when it is decoded
+    };
+
+    //marks the unused rest of the ring buffer in front of a record that did not fit before the end
+    constexpr std::uint32_t padding_site = 0xFFFF'FFFF;
+    constexpr std::size_t record_alignment = 8;
+
+    [[nodiscard]] static constexpr std::size_t alignedSize(std::size_t size) noexcept
+    {
+        return (size + record_alignment - 1) & ~(record_alignment - 1);
+    }
+
+    /**
+    * \brief Single-producer single-consumer ring buffer of binary records. Every logging thread owns one, the decoder thread reads all of them
+    */
+    class BinaryRing
+    {
+    public:
+        explicit BinaryRing(std::size_t capacity) : capacity_{roundUpToPowerOfTwo(capacity)}, data_{std::make_unique<std::byte[]>(capacity_)}
+        {}
+
+        /// \brief Largest record that will ever fit
+        [[nodiscard]] std::size_t maxRecordSize() const noexcept
+        {
+            return capacity_ / 2;
+        }
+
+        /// \brief Producer side. Returns false if there is not enough space right now
+        [[nodiscard]] bool tryWrite(const BinaryRecordHeader& header, std::string_view payload) noexcept
+        {
+            const auto total = alignedSize(sizeof(header) + payload.size());
+
+            auto head = head_.load(std::memory_order_relaxed);
+            auto offset = head & (capacity_ - 1);
+            const auto until_end = capacity_ - offset;
+            const auto needed = total <= until_end ? total : until_end + total;
+
+            if (head + needed - cachedTail_ > capacity_) {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head + needed - cachedTail_ > capacity_) {
+                    return false;
+                }
+            }
+
+            if (total > until_end) {
+                std::memcpy(data_.get() + offset, &padding_site, sizeof(padding_site));
+                head += until_end;
+                offset = 0;
+            }
+
+            std::memcpy(data_.get() + offset, &header, sizeof(header));
+            std::memcpy(data_.get() + offset + sizeof(header), payload.data(), payload.size());
+            head_.store(head + total, std::memory_order_release);
+
+            return true;
+        }
+
+        /// \brief Consumer side. Calls f with the header and payload of every record. Returns false if the ring was empty
+        template <typename F>
+        bool drain(F&& f) noexcept
+        {
+            auto tail = tail_.load(std::memory_order_relaxed);
+            const auto head = head_.load(std::memory_order_acquire);
+
+            if (tail == head) {
+                return false;
+            }
+
+            while (tail != head) {
+                const auto offset = tail & (capacity_ - 1);
+
+                std::uint32_t site{};
+                std::memcpy(&site, data_.get() + offset, sizeof(site));
+                if (site == padding_site) {
+                    tail += capacity_ - offset;
+                    continue;
+                }
+
+                BinaryRecordHeader header{};
+                std::memcpy(&header, data_.get() + offset, sizeof(header));
+                f(header, data_.get() + offset + sizeof(header));
+
+                //free the space right away so a waiting producer can continue
+                tail += alignedSize(sizeof(header) + header.size);
+                tail_.store(tail, std::memory_order_release);
+            }
+            tail_.store(tail, std::memory_order_release);
+
+            return true;
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+        }
+
+        ///set by the producer while it is writing so disableBinaryLogging() can wait for it
+        std::atomic<bool> busy{false};
+
+    private:
+        [[nodiscard]] static std::size_t roundUpToPowerOfTwo(std::size_t value) noexcept
+        {
+            std::size_t result = 4096;
+            while (result < value) {
+                result <<= 1U;
+            }
+            return result;
+        }
+
+        const std::size_t capacity_;
+        std::unique_ptr<std::byte[]> data_; //NOLINT(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+
+        alignas(cache_line_size) std::atomic<std::uint64_t> head_{0};
+        std::uint64_t cachedTail_{0}; //only used by the producer
+
+        alignas(cache_line_size) std::atomic<std::uint64_t> tail_{0};
+    };
+
+    //plain atomics so they are usable before the decoder is constructed and after it is destroyed
+    static std::atomic<bool> binaryEnabled{false};
+    static std::atomic<std::size_t> ringCapacity{std::size_t{1} << 20U};
+    static std::atomic<std::uint64_t> droppedRecords{0};
+
+    //the decoder cannot wait for itself, so records it logs (e.g. from a sink) are formatted right away
+    static thread_local bool onDecoderThread{false};
+
+    class BinaryLog
+    {
+    public:
+        BinaryLog() = default;
+
+        BinaryLog(const BinaryLog&) = delete;
+        BinaryLog(BinaryLog&&) = delete;
+
+        BinaryLog& operator=(const BinaryLog&) = delete;
+        BinaryLog& operator=(BinaryLog&&) = delete;
+
+        ~BinaryLog() noexcept
+        {
+            stop();
+        }
+
+        void start()
+        {
+            std::lock_guard control{controlMtx_};
+            if (decoder_.joinable()) {
+                return;
+            }
+
+            stopRequested_ = false;
+            decoder_ = std::thread{[this] { run(); }};
+            binaryEnabled.store(true, std::memory_order_seq_cst);
+        }
+
+        void stop() noexcept
+        {
+            std::lock_guard control{controlMtx_};
+            if (!decoder_.joinable()) {
+                return;
+            }
+
+            //the decoder keeps going until no producer is writing anymore and every ring is empty
+            binaryEnabled.store(false, std::memory_order_seq_cst);
+            {
+                std::lock_guard lock{mtx_};
+                stopRequested_ = true;
+            }
+            wakeup_.notify_one();
+            decoder_.join();
+        }
+
+        void drain() noexcept
+        {
+            std::unique_lock lock{mtx_};
+            if (stopRequested_ || !decoder_.joinable()) {
+                return;
+            }
+            const auto target = ++requestedPass_;
+            wakeup_.notify_one();
+            passDone_.wait(lock, [this, target] { return completedPass_ >= target || stopRequested_; });
+        }
+
+        void wake() noexcept
+        {
+            wakeup_.notify_one();
+        }
+
+        [[nodiscard]] std::uint32_t registerSite(BinaryDecoder decoder)
+        {
+            std::lock_guard lock{sitesMtx_};
+            sites_.push_back(decoder);
+            return static_cast<std::uint32_t>(sites_.size() - 1);
+        }
+
+        void addRing(std::shared_ptr<BinaryRing> ring)
+        {
+            std::lock_guard lock{ringsMtx_};
+            rings_.push_back(std::move(ring));
+        }
+
+    private:
+        void run() noexcept
+        {
+            using namespace std::chrono_literals;
+
+            std::vector<std::shared_ptr<BinaryRing>> rings;
+            std::vector<BinaryDecoder> sites;
+            onDecoderThread = true;
+
+            std::unique_lock lock{mtx_};
+            while (true) {
+                const auto pass = requestedPass_;
+                const bool stopping = stopRequested_;
+                lock.unlock();
+
+                {
+                    std::lock_guard rings_lock{ringsMtx_};
+                    rings = rings_;
+                }
+
+                bool did_work = false;
+                bool idle = true;
+                for (const auto& ring : rings) {
+                    did_work |= ring->drain([&](const BinaryRecordHeader& header, const std::byte* payload) {
+                        decode(sites, header, payload);
+                    });
+                    idle = idle && !ring->busy.load(std::memory_order_seq_cst) && ring->empty();
+                }
+                rings.clear();
+                removeAbandonedRings();
+
+                lock.lock();
+                completedPass_ = pass;
+                passDone_.notify_all();
+
+                if (stopping && idle) {
+                    break;
+                }
+                if (!did_work && requestedPass_ == pass && stopRequested_ == stopping) {
+                    //producers never notify us unless their ring is full, so poll
+                    wakeup_.wait_for(lock, 1ms);
+                }
+            }
+        }
+
+        void decode(std::vector<BinaryDecoder>& sites, const BinaryRecordHeader& header, const std::byte* payload) noexcept
+        {
+            if (header.site >= sites.size()) {
+                //a new site was registered since we last looked
+                std::lock_guard lock{sitesMtx_};
+                sites = sites_;
+            }
+            if (header.site >= sites.size()) {
+                droppedRecords.fetch_add(1, std::memory_order_relaxed); //corrupted record, there is no way to decode it
+                return;
+            }
+
+            auto& buffer = messageBuffer();
+            const auto marker = beginRecordAt(
+                buffer, *header.channel, static_cast<LogLevel>(header.level), header.with_label != 0, header.timestamp);
+            sites[header.site](buffer, payload);
+            endRecord(buffer, marker);
+        }
+
+        void removeAbandonedRings() noexcept
+        {
+            std::lock_guard lock{ringsMtx_};
+            rings_.erase(
+                std::remove_if(
+                    rings_.begin(),
+                    rings_.end(),
+                    [](const auto& ring) { return ring.use_count() == 1 && ring->empty(); }), //the owning thread has exited
+                rings_.end());
+        }
+
+        std::mutex controlMtx_;
+
+        std::mutex mtx_;
+        std::condition_variable wakeup_;
+        std::condition_variable passDone_;
+        std::uint64_t requestedPass_{0};
+        std::uint64_t completedPass_{0};
+        bool stopRequested_{false};
+        std::thread decoder_;
+
+        std::mutex sitesMtx_;
+        std::vector<BinaryDecoder> sites_;
+
+        std::mutex ringsMtx_;
+        std::vector<std::shared_ptr<BinaryRing>> rings_;
+    };
+
+    //constructed on first use, i.e. after the output it writes to, so it is also destroyed (and drained) before it
+    [[nodiscard]] static BinaryLog& binaryLog()
+    {
+        static BinaryLog instance;
+        return instance;
+    }
+
+    [[nodiscard]] static BinaryRing& localRing()
+    {
+        static thread_local const auto ring = [] {
+            auto new_ring = std::make_shared<BinaryRing>(ringCapacity.load(std::memory_order_relaxed));
+            binaryLog().addRing(new_ring);
+            return new_ring;
+        }();
+        return *ring;
+    }
+
+    static thread_local std::string binaryScratch;
+
+    std::uint32_t registerBinarySite(BinaryDecoder decoder) noexcept
+    {
+        try {
+            return binaryLog().registerSite(decoder);
+        } catch (...) {
+            //starting the decoder thread or growing the site table failed
+            return invalid_binary_site;
+        }
+    }
+
+    bool binaryLoggingEnabled() noexcept
+    {
+        return binaryEnabled.load(std::memory_order_relaxed);
+    }
+
+    std::string& binaryScratchBuffer() noexcept
+    {
+        return binaryScratch;
+    }
+
+    bool writeBinaryRecord(std::uint32_t site, const ChannelState& channel, LogLevel level, bool with_label, std::string_view payload) noexcept
+    {
+        auto& ring = localRing();
+
+        //announce the write before checking if we may write at all, see BinaryLog::stop()
+        ring.busy.store(true, std::memory_order_seq_cst);
+        const auto finished = Finally{[&ring]() noexcept { ring.busy.store(false, std::memory_order_release); }};
+
+        if (!binaryEnabled.load(std::memory_order_seq_cst) || onDecoderThread) {
+            return false;
+        }
+        if (sizeof(BinaryRecordHeader) + payload.size() > ring.maxRecordSize()) {
+            //the caller formats this record itself, the older records of this thread have to be written before it
+            if (!ring.empty()) {
+                binaryLog().drain();
+            }
+            return false;
+        }
+
+        const BinaryRecordHeader header{
+            site,
+            static_cast<std::uint32_t>(payload.size()),
+            static_cast<std::uint32_t>(level),
+            with_label ? 1U : 0U,
+            &channel,
+            timestampNow()};
+
+        while (!ring.tryWrite(header, payload)) {
+            //the ring is full, so wait for the decoder to catch up
+            if (!binaryEnabled.load(std::memory_order_acquire)) {
+                return false;
+            }
+            binaryLog().wake();
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    std::uint64_t binaryDropped() noexcept
+    {
+        return droppedRecords.load(std::memory_order_relaxed);
+    }
+
+    void drainBinaryLog() noexcept
+    {
+        if (binaryEnabled.load(std::memory_order_acquire)) {
+            binaryLog().drain();
+        }
+    }
+
+} // namespace Logger::details
+
+namespace Logger {
+
+    void enableBinaryLogging(std::size_t ring_size)
+    {
+        details::ringCapacity.store(ring_size, std::memory_order_relaxed);
+        details::binaryLog().start();
+    }
+
+    void disableBinaryLogging() noexcept
+    {
+        details::binaryLog().stop();
+    }
+
+} // namespace Logger
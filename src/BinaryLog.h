@@ -0,0 +1,45 @@
+/**
+*\file BinaryLog.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Ring buffers and decoder thread of the binary log mode
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef BINARYLOG_H_
+#define BINARYLOG_H_
+
+#include <cstdint>
+
+namespace Logger::details {
+
+    /**
+    * \brief Wait until every binary record written so far has been decoded and handed to the output. Does nothing if binary logging is disabled
+    */
+    void drainBinaryLog() noexcept;
+
+    /// \brief Number of binary records the decoder could not decode
+    [[nodiscard]] std::uint64_t binaryDropped() noexcept;
+
+} // namespace Logger::details
+
+#endif /* BINARYLOG_H_ */
@@ -0,0 +1,201 @@
+/**
+*\file CrashHandler.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Last-resort output of buffered records when the process crashes
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+#include "CrashHandler.h"
+#include "FileSink.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <new>
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+    #include <csignal>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace Logger::details {
+
+    //a fixed table, so the handler can walk it without locking or allocating
+    static std::array<std::atomic<FileSink*>, 64> crashFiles{};
+
+    static std::array<char, 4096> crashLogPath{};
+    static std::atomic<bool> crashLogPathSet{false};
+
+    static std::atomic<bool> crashing{false};
+
+    void addCrashFile(FileSink* file) noexcept
+    {
+        for (auto& slot : crashFiles) {
+            FileSink* expected = nullptr;
+            if (slot.compare_exchange_strong(expected, file, std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+    }
+
+    void removeCrashFile(FileSink* file) noexcept
+    {
+        for (auto& slot : crashFiles) {
+            FileSink* expected = file;
+            if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+    }
+
+    void setCrashLogPath(std::string_view path) noexcept
+    {
+        crashLogPathSet.store(false, std::memory_order_release);
+        if (path.empty() || path.size() >= crashLogPath.size()) {
+            return;
+        }
+
+        std::copy(path.begin(), path.end(), crashLogPath.begin());
+        crashLogPath[path.size()] = '\0';
+        crashLogPathSet.store(true, std::memory_order_release);
+    }
+
+    /// \brief Write everything that is still in memory. Only runs once, even if several threads crash at the same time
+    static void emergencyFlush() noexcept
+    {
+        if (crashing.exchange(true)) {
+            return;
+        }
+
+        //log files first, the records in them are older than the ones that are still queued
+        for (auto& slot : crashFiles) {
+            if (auto* file = slot.load(std::memory_order_acquire); file != nullptr) {
+                file->emergencyFlush();
+            }
+        }
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        int fd = STDERR_FILENO;
+        if (crashLogPathSet.load(std::memory_order_acquire)) {
+            if (const int log_fd = ::open(crashLogPath.data(), O_WRONLY | O_APPEND); log_fd >= 0) { //NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+                fd = log_fd;
+            }
+        }
+
+        writePendingRecords(fd);
+
+        if (fd != STDERR_FILENO) {
+            ::close(fd);
+        }
+#endif
+    }
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+    constexpr std::array crash_signals{SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+    static std::array<struct sigaction, crash_signals.size()> previousActions{};
+
+    static void onCrashSignal(int signal) noexcept
+    {
+        emergencyFlush();
+
+        //hand the signal to whoever handled it before, by default that terminates the process (and dumps core)
+        for (std::size_t i = 0; i < crash_signals.size(); i++) {
+            if (crash_signals[i] == signal) {
+                ::sigaction(signal, &previousActions[i], nullptr);
+            }
+        }
+        std::raise(signal);
+    }
+
+    /// \brief Give the calling thread a stack for signal handlers, so a stack overflow can still be handled
+    static void installAlternateStack() noexcept
+    {
+        stack_t current{};
+        if (::sigaltstack(nullptr, &current) == 0 && (current.ss_flags & SS_DISABLE) == 0) {
+            return; //the program brought its own
+        }
+
+        //never freed, the handler may run until the very end of the process
+        const auto size = std::max<std::size_t>(SIGSTKSZ, 64 * 1024);
+        auto* memory = new (std::nothrow) char[size]; //NOLINT(cppcoreguidelines-owning-memory)
+        if (memory == nullptr) {
+            return;
+        }
+
+        stack_t stack{};
+        stack.ss_sp = memory;
+        stack.ss_size = size;
+        stack.ss_flags = 0;
+        if (::sigaltstack(&stack, nullptr) != 0) {
+            delete[] memory; //NOLINT(cppcoreguidelines-owning-memory)
+        }
+    }
+#endif
+
+    static std::terminate_handler previousTerminate{nullptr};
+
+    [[noreturn]] static void onTerminate() noexcept
+    {
+        //std::terminate may be called while this thread holds a lock of the logger, so the regular flush() is not safe here
+        emergencyFlush();
+
+        if (previousTerminate != nullptr) {
+            previousTerminate();
+        }
+        std::abort();
+    }
+
+} // namespace Logger::details
+
+namespace Logger {
+
+    void installCrashHandler() noexcept
+    {
+        static std::atomic<bool> installed{false};
+        if (installed.exchange(true)) {
+            return;
+        }
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        details::installAlternateStack();
+
+        struct sigaction action
+        {};
+        action.sa_handler = &details::onCrashSignal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_ONSTACK;
+
+        for (std::size_t i = 0; i < details::crash_signals.size(); i++) {
+            ::sigaction(details::crash_signals[i], &action, &details::previousActions[i]);
+        }
+#endif
+
+        details::previousTerminate = std::set_terminate(&details::onTerminate);
+    }
+
+} // namespace Logger
@@ -0,0 +1,61 @@
+/**
+*\file CrashHandler.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Last-resort output of buffered records when the process crashes
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef CRASHHANDLER_H_
+#define CRASHHANDLER_H_
+
+#include "OutputFile.h"
+
+#include <string_view>
+
+namespace Logger::details {
+
+    class FileSink;
+
+    /**
+    * \brief Let the crash handler write the buffer of file to disk. Called when the file is opened
+    */
+    void addCrashFile(FileSink* file) noexcept;
+
+    /**
+    * \brief Called before file is closed
+    */
+    void removeCrashFile(FileSink* file) noexcept;
+
+    /**
+    * \brief Records that have not reached their sinks yet are appended to the file at path after a crash. Empty for stderr
+    */
+    void setCrashLogPath(std::string_view path) noexcept;
+
+    /**
+    * \brief Write every record in the asynchronous queue and the thread buffers to fd, without taking a lock. Defined in Logger.cpp
+    */
+    void writePendingRecords(int fd) noexcept;
+
+} // namespace Logger::details
+
+#endif /* CRASHHANDLER_H_ */
@@ -0,0 +1,407 @@
+/**
+*\file FileSink.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Buffered file output used by initLogFile
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+
+#include "FileSink.h"
+#include "CrashHandler.h"
+#include "Stats.h"
+
+#if __has_include(<filesystem>)
+    #include <filesystem>
+namespace fs = std::filesystem;
+#else
+    #include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#if RAYCHELLOGGER_HAS_ZLIB
+    #include <zlib.h>
+#endif
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace Logger::details {
+
+    /// \brief Compress source into destination and remove source. Returns false if nothing was compressed
+    static bool compressFile([[maybe_unused]] const std::string& source, [[maybe_unused]] const std::string& destination) noexcept
+    {
+#if RAYCHELLOGGER_HAS_ZLIB
+        std::ifstream in{source, std::ios::binary};
+        gzFile out = gzopen(destination.c_str(), "wb");
+        if (!in.is_open() || out == nullptr) {
+            if (out != nullptr) {
+                gzclose(out);
+            }
+            return false;
+        }
+
+        std::array<char, 64 * 1024> chunk{};
+        while (in) {
+            in.read(chunk.data(), chunk.size());
+            const auto count = static_cast<unsigned>(in.gcount());
+            if (count != 0 && gzwrite(out, chunk.data(), count) != static_cast<int>(count)) {
+                break;
+            }
+        }
+        const bool ok = in.eof() && gzclose(out) == Z_OK;
+        in.close();
+
+        std::error_code ec;
+        fs::remove(ok ? fs::path{source} : fs::path{destination}, ec);
+        return ok;
+#else
+        return false;
+#endif
+    }
+
+    bool FileSink::open(const std::string& path, const FileSinkOptions& options)
+    {
+        close();
+
+        std::lock_guard lock{mtx_};
+
+        file_ = OutputFile::open(path);
+        if (!file_) {
+            return false;
+        }
+
+        path_ = path;
+        options_ = options;
+        options_.rotation.max_files = std::max<std::size_t>(options_.rotation.max_files, 1);
+        buffer_.clear();
+        bufferedRecords_ = 0;
+        buffer_.reserve(options_.buffer_size);
+        spare_.reserve(options_.buffer_size);
+        fileSize_ = 0;
+        rotating_ = false;
+        rotationRequested_ = false;
+        open_ = true;
+
+        if (needsWorker()) {
+            stopRequested_ = false;
+            worker_ = std::thread{[this] { run(); }};
+        }
+
+        addCrashFile(this);
+        return true;
+    }
+
+    bool FileSink::isOpen() const noexcept
+    {
+        std::lock_guard lock{mtx_};
+        return open_;
+    }
+
+    void FileSink::write(std::string_view records, LogLevel level) noexcept
+    {
+        std::lock_guard lock{mtx_};
+
+        if (!open_) {
+            return;
+        }
+        countWritten(records.size());
+
+        if (buffer_.size() + records.size() > options_.buffer_size) {
+            flushLocked();
+        }
+
+        if (records.size() >= options_.buffer_size && !rotating_) {
+            //would not fit anyway, no need to copy it
+            writeLocked(records, 1);
+            return;
+        }
+        buffer_.append(records);
+        bufferedRecords_++;
+
+        if (mustFlush(level)) {
+            flushLocked();
+        }
+    }
+
+    void FileSink::write(const std::string_view* records, std::size_t count, LogLevel level) noexcept
+    {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            size += records[i].size(); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+
+        std::lock_guard lock{mtx_};
+
+        if (!open_) {
+            return;
+        }
+        countWritten(size);
+
+        if (rotating_ || buffer_.size() + size <= options_.buffer_size) {
+            for (std::size_t i = 0; i < count; i++) {
+                buffer_.append(records[i]); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            }
+            bufferedRecords_ += count;
+            if (mustFlush(level)) {
+                flushLocked();
+            }
+            return;
+        }
+
+        //the buffer and the whole batch go out in one go, the records themselves are never copied
+        if (reopenIfClosed()) {
+            const FlushTimer timer;
+            file_->write(buffer_, records, count);
+        } else {
+            bump(threadStats().file_dropped, bufferedRecords_ + count);
+        }
+        buffer_.clear();
+        bufferedRecords_ = 0;
+    }
+
+    void FileSink::flush() noexcept
+    {
+        std::lock_guard lock{mtx_};
+        flushLocked();
+    }
+
+    void FileSink::close() noexcept
+    {
+        removeCrashFile(this);
+        stopWorker();
+
+        std::lock_guard lock{mtx_};
+        if (open_) {
+            flushLocked();
+            file_.reset();
+            open_ = false;
+        }
+    }
+
+    void FileSink::emergencyFlush() const noexcept
+    {
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        //file_ is unbuffered, so the buffer is all that has not reached the operating system yet
+        if (!open_ || rotating_ || buffer_.empty()) {
+            return;
+        }
+
+        const int fd = ::open(path_.c_str(), O_WRONLY | O_APPEND); //NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        if (fd >= 0) {
+            writeFully(fd, buffer_);
+            ::close(fd);
+        }
+#endif
+    }
+
+    bool FileSink::needsWorker() const noexcept
+    {
+        return options_.flush.interval.count() > 0 || options_.rotation.max_size != 0 || options_.rotation.interval.count() > 0;
+    }
+
+    void FileSink::flushLocked() noexcept
+    {
+        if (rotating_) {
+            return; //the worker writes the buffer into the new file once it is open
+        }
+        if (!buffer_.empty()) {
+            writeLocked(buffer_, bufferedRecords_);
+            buffer_.clear();
+            bufferedRecords_ = 0;
+        }
+    }
+
+    void FileSink::writeLocked(std::string_view data, std::size_t records) noexcept
+    {
+        if (reopenIfClosed()) {
+            const FlushTimer timer;
+            file_->write(data);
+        } else {
+            bump(threadStats().file_dropped, records);
+        }
+    }
+
+    bool FileSink::reopenIfClosed() noexcept
+    {
+        if (!file_ && open_ && !rotating_) {
+            //rotate() could not create the new file, the old one is already renamed
+            file_ = OutputFile::open(path_);
+        }
+        return file_ != nullptr;
+    }
+
+    void FileSink::countWritten(std::size_t size) noexcept
+    {
+        fileSize_ += size;
+
+        const auto& rotation = options_.rotation;
+        if (rotation.max_size != 0 && fileSize_ >= rotation.max_size && !rotating_ && !rotationRequested_) {
+            rotationRequested_ = true;
+            wakeup_.notify_one();
+        }
+    }
+
+    bool FileSink::mustFlush(LogLevel level) const noexcept
+    {
+        const auto& policy = options_.flush;
+        const bool urgent = level >= policy.min_level && level != LogLevel::log;
+        const bool enough_bytes = policy.every_bytes != 0 && buffer_.size() >= policy.every_bytes;
+
+        return policy.every_record || urgent || enough_bytes;
+    }
+
+    void FileSink::run() noexcept
+    {
+        using clock = std::chrono::steady_clock;
+
+        const auto flush_interval = options_.flush.interval;
+        const auto rotation_interval = std::chrono::duration_cast<clock::duration>(options_.rotation.interval);
+
+        auto next_flush = clock::now() + flush_interval;
+        auto next_rotation = clock::now() + rotation_interval;
+
+        const auto wake_up = [this] { return stopRequested_ || rotationRequested_; };
+
+        std::unique_lock lock{mtx_};
+        while (!stopRequested_) {
+            if (flush_interval.count() > 0 && rotation_interval.count() > 0) {
+                wakeup_.wait_until(lock, std::min(next_flush, next_rotation), wake_up);
+            } else if (flush_interval.count() > 0) {
+                wakeup_.wait_until(lock, next_flush, wake_up);
+            } else if (rotation_interval.count() > 0) {
+                wakeup_.wait_until(lock, next_rotation, wake_up);
+            } else {
+                wakeup_.wait(lock, wake_up);
+            }
+
+            if (stopRequested_) {
+                break;
+            }
+
+            const auto now = clock::now();
+            if (rotationRequested_ || (rotation_interval.count() > 0 && now >= next_rotation)) {
+                rotate(lock);
+                next_rotation = clock::now() + rotation_interval;
+            }
+            if (flush_interval.count() > 0 && now >= next_flush) {
+                flushLocked();
+                next_flush = now + flush_interval;
+            }
+        }
+    }
+
+    void FileSink::rotate(std::unique_lock<std::mutex>& lock) noexcept
+    {
+        rotationRequested_ = false;
+        rotating_ = true;
+
+        //writers keep appending to the (now empty) buffer while we work on the files
+        auto old_file = std::move(file_);
+        buffer_.swap(spare_);
+        const auto spare_records = std::exchange(bufferedRecords_, 0);
+        const bool compress = options_.rotation.compress;
+        lock.unlock();
+
+        if (old_file) {
+            old_file->write(spare_);
+            old_file.reset();
+        } else if (!spare_.empty()) {
+            bump(threadStats().file_dropped, spare_records);
+        }
+        spare_.clear();
+
+        shiftRotatedFiles();
+        auto new_file = OutputFile::open(path_);
+
+        lock.lock();
+        file_ = std::move(new_file);
+        rotating_ = false;
+        fileSize_ = buffer_.size();
+        flushLocked();
+        lock.unlock();
+
+        if (compress && !compressFile(rotatedName(1, false), rotatedName(1, true))) {
+            //the file stays uncompressed, shiftRotatedFiles() moves it along like the compressed ones
+            bump(threadStats().file_errors);
+        }
+
+        lock.lock();
+    }
+
+    void FileSink::shiftRotatedFiles() const noexcept
+    {
+        //a missing file is not an error, most of the names do not exist until the sink has rotated max_files times
+        const auto count_error = [](const std::error_code& ec) {
+            if (ec && ec != std::errc::no_such_file_or_directory) {
+                bump(threadStats().file_errors);
+            }
+        };
+
+        try {
+            //a file whose compression failed keeps its plain name, so both forms are shifted. Only one of them exists per index
+            for (const bool compressed : {false, true}) {
+                std::error_code ec;
+                fs::remove(rotatedName(options_.rotation.max_files, compressed), ec);
+                count_error(ec);
+                for (auto i = options_.rotation.max_files - 1; i > 0; i--) {
+                    fs::rename(rotatedName(i, compressed), rotatedName(i + 1, compressed), ec);
+                    count_error(ec);
+                }
+            }
+
+            std::error_code ec;
+            fs::rename(path_, rotatedName(1, false), ec);
+            count_error(ec);
+        } catch (const std::bad_alloc&) {
+            bump(threadStats().file_errors); //no memory for the names, the files stay where they are
+        }
+    }
+
+    std::string FileSink::rotatedName(std::size_t index, bool compressed) const
+    {
+        return path_ + '.' + std::to_string(index) + (compressed ? ".gz" : "");
+    }
+
+    void FileSink::stopWorker() noexcept
+    {
+        {
+            std::lock_guard lock{mtx_};
+            if (!worker_.joinable()) {
+                return;
+            }
+            stopRequested_ = true;
+        }
+        wakeup_.notify_one();
+        worker_.join();
+    }
+
+} // namespace Logger::details
@@ -0,0 +1,154 @@
+/**
+*\file FileSink.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Buffered file output used by initLogFile
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+#ifndef FILESINK_H_
+#define FILESINK_H_
+
+#include "OutputFile.h"
+#include "RaychelLogger/Logger.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace Logger::details {
+
+    /**
+    * \brief Log file with its own large write buffer. The file underneath is unbuffered, so data reaches
+    * the operating system exactly when the flush policy says so. Timed flushes, rotation and compression run on a
+    * worker thread that only exists if one of them is enabled
+    */
+    class FileSink
+    {
+    public:
+        FileSink() = default;
+
+        FileSink(const FileSink&) = delete;
+        FileSink(FileSink&&) = delete;
+
+        FileSink& operator=(const FileSink&) = delete;
+        FileSink& operator=(FileSink&&) = delete;
+
+        ~FileSink() noexcept
+        {
+            close();
+        }
+
+        /**
+        * \brief Open a new log file. A file that is still open is flushed and closed first
+        * 
+        * \param path Path to the log file. Existing files are truncated
+        * \param options Buffer size, flush and rotation policy
+        * \return true if the file could be opened
+        */
+        [[nodiscard]] bool open(const std::string& path, const FileSinkOptions& options);
+
+        [[nodiscard]] bool isOpen() const noexcept;
+
+        /**
+        * \brief Append records to the buffer and flush it if the flush policy requires it. Never waits for a rotation
+        * 
+        * \param records One or more complete records
+        * \param level Highest level among records
+        */
+        void write(std::string_view records, LogLevel level) noexcept;
+
+        /**
+        * \brief Like write, but for a batch of separate records. A batch that does not fit the buffer is written together
+        * with the buffer in a single vectored write instead of being copied
+        * 
+        * \param records Complete records, in order
+        * \param level Highest level among records
+        */
+        void write(const std::string_view* records, std::size_t count, LogLevel level) noexcept;
+
+        /**
+        * \brief Hand everything in the buffer to the operating system. Does nothing while the file is being rotated
+        */
+        void flush() noexcept;
+
+        /**
+        * \brief Flush and close the file. Does nothing if no file is open
+        */
+        void close() noexcept;
+
+        /**
+        * \brief Append the buffer to the file with write(2), without locking. Only called by the crash handler
+        */
+        void emergencyFlush() const noexcept;
+
+    private:
+        [[nodiscard]] bool needsWorker() const noexcept;
+
+        void flushLocked() noexcept;
+
+        /// \brief Write data to the file. The records in it are counted as dropped if there is no file
+        void writeLocked(std::string_view data, std::size_t records) noexcept;
+
+        /// \brief Try to create the file again if a rotation could not. Returns whether there is a file to write to
+        [[nodiscard]] bool reopenIfClosed() noexcept;
+
+        /// \brief Account for size more bytes in the file and request a rotation if it is full
+        void countWritten(std::size_t size) noexcept;
+
+        [[nodiscard]] bool mustFlush(LogLevel level) const noexcept;
+
+        void run() noexcept;
+
+        void rotate(std::unique_lock<std::mutex>& lock) noexcept;
+
+        void shiftRotatedFiles() const noexcept;
+
+        [[nodiscard]] std::string rotatedName(std::size_t index, bool compressed) const;
+
+        void stopWorker() noexcept;
+
+        mutable std::mutex mtx_;
+        std::unique_ptr<OutputFile> file_; //empty while the file is being rotated or if the rotation could not create it
+        std::string path_;
+        std::string buffer_;
+        std::size_t bufferedRecords_{0};
+        std::string spare_; //takes the place of buffer_ during rotation so neither has to reallocate
+        FileSinkOptions options_;
+
+        std::size_t fileSize_{0}; //including buffered data
+        bool open_{false};
+        bool rotating_{false};
+        bool rotationRequested_{false};
+
+        std::thread worker_;
+        std::condition_variable wakeup_;
+        bool stopRequested_{false};
+    };
+
+} // namespace Logger::details
+
+#endif /* FILESINK_H_ */
@@ -0,0 +1,162 @@
+/**
+*\file Latency.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Scoped timers and per-label latency histograms
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+
+#include "RaychelLogger/Latency.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Logger {
+
+    static std::mutex histogramMtx;
+    static std::map<std::string, std::unique_ptr<LatencyHistogram>, std::less<>> histograms;
+
+    LatencySummary LatencyHistogram::summary() const noexcept
+    {
+        LatencySummary result;
+
+        //copy the buckets first so all percentiles are computed from the same counts
+        std::array<std::uint64_t, bucket_count> counts{};
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < bucket_count; i++) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        if (total == 0) {
+            return result;
+        }
+
+        const auto min = min_.load(std::memory_order_relaxed);
+        const auto max = max_.load(std::memory_order_relaxed);
+
+        const auto percentile = [&](double fraction) {
+            const auto target = static_cast<std::uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < bucket_count; i++) {
+                seen += counts[i];
+                if (seen >= target) {
+                    return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(std::min(highestValueIn(i), max))};
+                }
+            }
+            return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(max)};
+        };
+
+        result.count = total;
+        result.min = std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(min)};
+        result.max = std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(max)};
+        result.mean = std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(sum_.load(std::memory_order_relaxed) / total)};
+        result.p50 = percentile(0.5);
+        result.p99 = percentile(0.99);
+        result.p999 = percentile(0.999);
+
+        return result;
+    }
+
+    void LatencyHistogram::reset() noexcept
+    {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram& latencyHistogram(std::string_view label)
+    {
+        std::lock_guard lock{histogramMtx};
+
+        if (const auto it = histograms.find(label); it != histograms.end()) {
+            return *it->second;
+        }
+        return *histograms.emplace(std::string{label}, std::make_unique<LatencyHistogram>()).first->second;
+    }
+
+    /// \brief Durations are printed in microseconds with up to 6 significant digits
+    static auto us(std::chrono::nanoseconds duration) noexcept
+    {
+        return static_cast<double>(duration.count()) / 1000.0;
+    }
+
+    void logLatencyStats(LogLevel level, bool reset)
+    {
+        //log after releasing the lock, so a sink that measures its own latency cannot deadlock on it
+        std::vector<std::pair<std::string, LatencySummary>> summaries;
+        {
+            std::lock_guard lock{histogramMtx};
+
+            summaries.reserve(histograms.size());
+            for (const auto& [label, histogram] : histograms) {
+                const auto stats = histogram->summary();
+                if (reset) {
+                    histogram->reset();
+                }
+                if (stats.count != 0) {
+                    summaries.emplace_back(label, stats);
+                }
+            }
+        }
+
+        for (const auto& [label, stats] : summaries) {
+            log(level,
+                label,
+                ": count=",
+                stats.count,
+                " min=",
+                us(stats.min),
+                "us mean=",
+                us(stats.mean),
+                "us max=",
+                us(stats.max),
+                "us p50=",
+                us(stats.p50),
+                "us p99=",
+                us(stats.p99),
+                "us p999=",
+                us(stats.p999),
+                "us\n");
+        }
+    }
+
+    void resetLatencyStats() noexcept
+    {
+        std::lock_guard lock{histogramMtx};
+
+        for (const auto& [label, histogram] : histograms) {
+            histogram->reset();
+        }
+    }
+
+} // namespace Logger
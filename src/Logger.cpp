@@ -26,7 +26,15 @@
 *
 */
 
-#include "RaychelLogger/Logger.h"
+#include "RaychelLogger/Channel.h"
+
+#include "BinaryLog.h"
+#include "CrashHandler.h"
+#include "RecordRing.h"
+#include "Sinks.h"
+#include "Stats.h"
+#include "Structured.h"
+#include "Timestamp.h"
 
 #if __has_include(<filesystem>)
     #include <filesystem>
@@ -35,192 +43,870 @@ namespace fs = std::filesystem;
     #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
 #endif
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream> //std::cout has to be initialized before the default sinks below
+#include <map>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace Logger {
 
-    static LogLevel currentLevel = LogLevel::info;
-    static LogLevel minLogLevel = LogLevel::info;
 
-    static bool doColor = true;
-    constexpr std::string_view reset_col = "\x1b[0m";
+    static details::SinkRegistry sinks;
+    //points to sinks from the start, records can be logged before anything asks for the default channel
+    details::ChannelState details::defaultState{{LogLevel::info}, &sinks}; //NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
-    static std::ostream outStream{std::cout.rdbuf()};
-    static std::ofstream logFile;
+    //channels are never destroyed before the program exits, so records can point to them
+    static std::mutex channelsMtx;
+    static std::map<std::string, std::unique_ptr<Channel>, std::less<>> channels;
 
     static std::recursive_mutex mtx;
-    static bool mtx_engaged;
 
-    static std::unordered_map<std::string, timePoint_t> timePoints;
+    //labeled timers are a thin layer over TimerHandle. They have their own lock so they never contend with logging
+    static std::mutex timerMtx;
+    static std::unordered_map<std::string, TimerHandle> timers;
+
+    /// \brief Label and color of every level, indexed by LogLevel, and the layout of records
+    struct RecordStyle
+    {
+        std::array<std::string_view, 7> labels;
+        std::array<std::string_view, 7> colors;
+        RecordFormat format;
+    };
+
+    static constexpr RecordStyle default_style{
+        {"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL", "FATAL", "OUT"},
+        {
+            "\x1b[36m",     //DEBUG, light blue
+            "\x1b[32m",     //INFO, green
+            "\x1b[33m",     //WARNING, yellow
+            "\x1b[31m",     //ERROR, red
+            "\x1b[1;31m",   //CRITICAL, bold red
+            "\x1b[4;1;31m", //FATAL bold underlined red
+            "\x1b[34m"      //LOG, blue
+        },
+        RecordFormat::text};
+
+    //setLogLabel, setLogColor and setRecordFormat publish a new snapshot instead of changing the current one. Records hold
+    //no lock while they read a snapshot, so old snapshots and the text they point to are kept until the program exits
+    static std::atomic<const RecordStyle*> currentStyle{&default_style};
+    static std::mutex styleMtx;
+    static std::vector<std::unique_ptr<const RecordStyle>> styleSnapshots;
+    static std::deque<std::string> styleText;
+
+    //the traces passed to enableTrace are published the same way, as a sorted list that is searched without a lock
+    using TraceList = std::vector<std::uint64_t>;
+    static std::atomic<const TraceList*> enabledTraces{nullptr};
+    static std::mutex traceMtx;
+    static std::vector<std::unique_ptr<const TraceList>> traceSnapshots;
+
+    /// \brief Stream buffer that appends everything written to it to a std::string without buffering anything itself
+    class StringAppendBuffer : public std::streambuf
+    {
+    public:
+        explicit StringAppendBuffer(std::string& target) : target_{&target}
+        {}
+
+        std::string* retarget(std::string* target) noexcept
+        {
+            return std::exchange(target_, target);
+        }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                target_->push_back(traits_type::to_char_type(ch));
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize xsputn(const char_type* s, std::streamsize count) override
+        {
+            target_->append(s, static_cast<std::size_t>(count));
+            return count;
+        }
+
+    private:
+        std::string* target_;
+    };
+
+    static thread_local std::string messageBuf;
+    static thread_local std::string fieldsBuf; //fields of the records in messageBuf, encoded when the record is finished
+    static thread_local StringAppendBuffer messageStreamBuf{messageBuf};
+    static thread_local std::ostream messageOStream{&messageStreamBuf};
+
+    //set on the thread of the AsyncWriter. Records it logs itself (from a sink or an error path) cannot wait for it
+    static thread_local bool onAsyncWriterThread{false};
+
+    class AsyncWriter
+    {
+    public:
+        AsyncWriter() = default;
+
+        AsyncWriter(const AsyncWriter&) = delete;
+        AsyncWriter(AsyncWriter&&) = delete;
+
+        AsyncWriter& operator=(const AsyncWriter&) = delete;
+        AsyncWriter& operator=(AsyncWriter&&) = delete;
+
+        ~AsyncWriter() noexcept
+        {
+            stop();
+        }
+
+        void start(std::size_t capacity, OverflowPolicy policy)
+        {
+            std::lock_guard control{controlMtx_};
+            stopWriter();
+
+            ring_ = std::make_unique<details::RecordRing>(capacity == 0 ? 1 : capacity, slot_size);
+            policy_ = policy;
+            completed_.store(0, std::memory_order_relaxed);
+            highWater_.store(0, std::memory_order_relaxed);
+            stopRequested_.store(false, std::memory_order_seq_cst);
+            writer_ = std::thread{[this] { run(); }};
+            running_.store(true, std::memory_order_release);
+        }
+
+        void stop() noexcept
+        {
+            std::lock_guard control{controlMtx_};
+            stopWriter();
+        }
+
+        [[nodiscard]] bool running() const noexcept
+        {
+            return running_.load(std::memory_order_acquire);
+        }
+
+        /// \brief Queue a record for the writer thread. Returns false if the writer is not running and the caller has to write the record itself
+        [[nodiscard]] bool push(std::string_view record, const details::RecordInfo& info) noexcept
+        {
+            //announce ourselves before checking for a stop, so the writer does not exit while we are about to push
+            activeProducers_.fetch_add(1, std::memory_order_seq_cst);
+            const auto done = details::Finally{[this]() noexcept { activeProducers_.fetch_sub(1, std::memory_order_seq_cst); }};
+
+            //the writer would wait for a queue that only it empties, so it writes its own records directly
+            if (stopRequested_.load(std::memory_order_seq_cst) || onAsyncWriterThread) {
+                return false;
+            }
+
+            using PushResult = details::RecordRing::PushResult;
+            while (true) {
+                const auto result = ring_->tryPush(record, info);
+                if (result == PushResult::pushed) {
+                    break;
+                }
+                if (result == PushResult::no_memory) {
+                    //its slot is published empty, so the writer still has to be woken for it below
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+
+                switch (policy_) {
+                    case OverflowPolicy::block:
+                        if (stopRequested_.load(std::memory_order_seq_cst)) {
+                            return false;
+                        }
+                        wake();
+                        std::this_thread::yield();
+                        break;
+                    case OverflowPolicy::drop_newest:
+                        dropped_.fetch_add(1, std::memory_order_relaxed);
+                        return true;
+                    case OverflowPolicy::drop_oldest:
+                        if (ring_->tryPop([](std::string_view /*unused*/, const details::RecordInfo& /*unused*/) noexcept {})) {
+                            dropped_.fetch_add(1, std::memory_order_relaxed);
+                            completed_.fetch_add(1, std::memory_order_release);
+                        }
+                        break;
+                }
+            }
+
+            //the writer only sleeps while the queue is empty, so only the first record after that has to wake it
+            if (writerSleeping_.load(std::memory_order_seq_cst)) {
+                wake();
+            }
+            return true;
+        }
+
+        /// \brief Wait until every record queued so far has been written. Does not wait on the writer thread itself
+        void drain() noexcept
+        {
+            if (onAsyncWriterThread) {
+                return;
+            }
+
+            std::lock_guard control{controlMtx_};
+            if (!ring_ || !writer_.joinable()) {
+                return;
+            }
+
+            const auto target = ring_->pushed();
+            std::unique_lock lock{mtx_};
+            idle_.wait(lock, [this, target] { return completed_.load(std::memory_order_acquire) >= target; });
+        }
+
+        [[nodiscard]] std::size_t dropped() const noexcept
+        {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Number of records in the queue right now and the high-water mark since start()
+        void queueStats(LoggerStats& stats) const noexcept
+        {
+            std::lock_guard control{controlMtx_};
+            if (ring_) {
+                const auto pushed = ring_->pushed();
+                const auto completed = completed_.load(std::memory_order_acquire);
+                stats.queue_depth = pushed > completed ? pushed - completed : 0;
+            }
+            stats.queue_high_water = highWater_.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Crash handler only: take every queued record out of the ring and write it to fd. The ring is lock-free, so this is safe
+        void writePending(int fd) noexcept
+        {
+            if (!ring_) {
+                return;
+            }
+            while (ring_->tryPopInSignalHandler([fd](std::string_view record, const details::RecordInfo& info) noexcept {
+                details::writeFully(fd, details::plainText(record, info));
+            })) {
+            }
+        }
+
+    private:
+        //fixed text block of every slot. Longer records use the overflow pool of the ring
+        static constexpr std::size_t slot_size = 256;
+
+        //most records the writer takes out of the queue at once
+        static constexpr std::size_t batch_size = 256;
+
+        void stopWriter() noexcept
+        {
+            if (!writer_.joinable()) {
+                return;
+            }
+
+            running_.store(false, std::memory_order_release);
+            stopRequested_.store(true, std::memory_order_seq_cst);
+            wake();
+
+            //the writer empties the queue before it exits
+            writer_.join();
+        }
+
+        void wake() noexcept
+        {
+            std::lock_guard lock{mtx_};
+            wakeup_.notify_one();
+        }
+
+        void run() noexcept
+        {
+            using namespace std::chrono_literals;
+            onAsyncWriterThread = true;
+
+            //the records stay in their slots while they are written, the batch only holds views of them
+            std::array<std::string_view, batch_size> texts{};
+            std::array<details::RecordInfo, batch_size> infos{};
+            const auto write = [&texts, &infos](std::size_t count) noexcept {
+                details::writeRecords(texts.data(), infos.data(), count);
+            };
+
+            while (true) {
+                //only the writer measures the depth, producers never touch another cache line for it. Guarded like
+                //queueStats(), so two reads that do not match can never wrap around to a huge depth
+                const auto pushed = ring_->pushed();
+                const auto completed = completed_.load(std::memory_order_relaxed);
+                const auto depth = pushed > completed ? pushed - completed : 0;
+                if (depth > highWater_.load(std::memory_order_relaxed)) {
+                    highWater_.store(depth, std::memory_order_relaxed);
+                }
+
+                while (const auto count = ring_->tryPopBatch(texts.data(), infos.data(), batch_size, write)) {
+                    completed_.fetch_add(count, std::memory_order_release);
+                }
+
+                std::unique_lock lock{mtx_};
+                idle_.notify_all();
+
+                if (stopRequested_.load(std::memory_order_seq_cst) && activeProducers_.load(std::memory_order_seq_cst) == 0 &&
+                    ring_->empty()) {
+                    break; //stop was requested and everything has been written
+                }
+
+                writerSleeping_.store(true, std::memory_order_seq_cst);
+                if (ring_->empty() && !stopRequested_.load(std::memory_order_seq_cst)) {
+                    //the timeout only matters if a wakeup raced with us going to sleep
+                    wakeup_.wait_for(lock, 10ms);
+                }
+                writerSleeping_.store(false, std::memory_order_seq_cst);
+            }
+        }
+
+        mutable std::mutex controlMtx_;
+
+        std::mutex mtx_; //only used to sleep and wake up, never while pushing or writing a record
+        std::condition_variable wakeup_;
+        std::condition_variable idle_;
+
+        std::unique_ptr<details::RecordRing> ring_;
+        OverflowPolicy policy_{OverflowPolicy::block};
+
+        std::atomic<bool> stopRequested_{false};
+        std::atomic<bool> writerSleeping_{false};
+        std::atomic<std::size_t> activeProducers_{0};
+        std::atomic<std::uint64_t> completed_{0}; //records written or dropped from the queue
+        std::atomic<std::uint64_t> highWater_{0};
+
+        std::atomic<bool> running_{false};
+        std::atomic<std::size_t> dropped_{0};
+
+        std::thread writer_;
+    };
+
+    //must be declared after sinks so it is destroyed (and drained) before them
+    static AsyncWriter asyncWriter;
+
+    /// \brief Hand finished records to the asynchronous writer or write them directly
+    static void submit(std::string_view records, const details::RecordInfo* infos, std::size_t count) noexcept
+    {
+        std::size_t i = 0;
+        if (asyncWriter.running()) {
+            //the queue takes single records, so a batch is only split up here
+            std::size_t offset = 0;
+            for (; i < count && asyncWriter.push(records.substr(offset, infos[i].size), infos[i]); i++) {
+                offset += infos[i].size;
+            }
+            records.remove_prefix(offset);
+        }
+
+        if (i < count) {
+            details::writeRecords(records, infos + i, count - i);
+        }
+    }
+
+    struct ThreadBuffer
+    {
+        std::mutex mtx; //only contended while the flusher thread writes this buffer
+        std::string data;
+        std::vector<details::RecordInfo> infos; //layout of every record in data
+
+        void flush() noexcept
+        {
+            std::lock_guard lock{mtx};
+            flushLocked();
+        }
+
+        void flushLocked() noexcept
+        {
+            if (!data.empty()) {
+                submit(data, infos.data(), infos.size());
+                data.clear();
+                infos.clear();
+            }
+        }
+    };
+
+    class ThreadBuffers
+    {
+    public:
+        ThreadBuffers() = default;
+
+        ThreadBuffers(const ThreadBuffers&) = delete;
+        ThreadBuffers(ThreadBuffers&&) = delete;
+
+        ThreadBuffers& operator=(const ThreadBuffers&) = delete;
+        ThreadBuffers& operator=(ThreadBuffers&&) = delete;
+
+        ~ThreadBuffers() noexcept
+        {
+            disable();
+        }
+
+        void enable(std::size_t capacity, std::chrono::milliseconds interval)
+        {
+            std::lock_guard control{controlMtx_};
+            stopFlusher();
+
+            capacity_.store(capacity, std::memory_order_relaxed);
+            interval_ = interval;
+            stopRequested_ = false;
+            flusher_ = std::thread{[this] { run(); }};
+            enabled_.store(true, std::memory_order_release);
+        }
+
+        void disable() noexcept
+        {
+            std::lock_guard control{controlMtx_};
+            enabled_.store(false, std::memory_order_release);
+            stopFlusher();
+            flushAll();
+        }
+
+        [[nodiscard]] bool enabled() const noexcept
+        {
+            return enabled_.load(std::memory_order_acquire);
+        }
+
+        /// \brief Append a record to the buffer of the calling thread. Returns false if thread buffering is disabled
+        [[nodiscard]] bool append(ThreadBuffer& buffer, std::string_view record, const details::RecordInfo& info) noexcept
+        {
+            if (!enabled_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            const auto capacity = capacity_.load(std::memory_order_relaxed);
+
+            std::lock_guard lock{buffer.mtx};
+            if (buffer.data.size() + record.size() > capacity) {
+                buffer.flushLocked();
+            }
+
+            if (record.size() >= capacity) {
+                submit(record, &info, 1);
+            } else {
+                buffer.data.append(record);
+                buffer.infos.push_back(info);
+            }
+            return true;
+        }
+
+        void flushAll() noexcept
+        {
+            std::lock_guard lock{registryMtx_};
+            for (auto* buffer : buffers_) {
+                buffer->flush();
+            }
+        }
+
+        /// \brief Crash handler only: write every buffered record to fd without locking. Records that are being appended may be cut off
+        void writePending(int fd) const noexcept
+        {
+            for (const auto* buffer : buffers_) {
+                std::size_t offset = 0;
+                for (const auto& info : buffer->infos) {
+                    details::writeFully(fd, details::plainText(std::string_view{buffer->data}.substr(offset, info.size), info));
+                    offset += info.size;
+                }
+            }
+        }
+
+        void add(ThreadBuffer& buffer)
+        {
+            std::lock_guard lock{registryMtx_};
+            buffers_.push_back(&buffer);
+        }
+
+        void remove(ThreadBuffer& buffer) noexcept
+        {
+            std::lock_guard lock{registryMtx_};
+            buffers_.erase(std::remove(buffers_.begin(), buffers_.end(), &buffer), buffers_.end());
+        }
+
+    private:
+        void stopFlusher() noexcept
+        {
+            {
+                std::lock_guard lock{flusherMtx_};
+                if (!flusher_.joinable()) {
+                    return;
+                }
+                stopRequested_ = true;
+            }
+            wakeup_.notify_one();
+            flusher_.join();
+        }
+
+        void run() noexcept
+        {
+            std::unique_lock lock{flusherMtx_};
+            while (!stopRequested_) {
+                if (!wakeup_.wait_for(lock, interval_, [this] { return stopRequested_; })) {
+                    lock.unlock();
+                    flushAll();
+                    lock.lock();
+                }
+            }
+        }
 
-    static std::array<std::string_view, 7> levelLabels = {"DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL", "FATAL", "OUT"};
+        std::mutex controlMtx_;
 
-    static std::array<std::string_view, 7> cols = {
-        "\x1b[36m",     //DEBUG, light blue
-        "\x1b[32m",     //INFO, green
-        "\x1b[33m",     //WARNING, yellow
-        "\x1b[31m",     //ERROR, red
-        "\x1b[1;31m",   //CRITICAL, bold red
-        "\x1b[4;1;31m", //FATAL bold underlined red
-        "\x1b[34m"      //LOG, blue
+        std::mutex registryMtx_;
+        std::vector<ThreadBuffer*> buffers_;
+
+        std::mutex flusherMtx_;
+        std::condition_variable wakeup_;
+        std::chrono::milliseconds interval_{100};
+        bool stopRequested_{false};
+        std::thread flusher_;
+
+        std::atomic<bool> enabled_{false};
+        std::atomic<std::size_t> capacity_{0};
     };
 
-    std::string_view getLogLabel()
+    //declared after asyncWriter so buffered records can still be queued while this is destroyed
+    static ThreadBuffers threadBuffers;
+
+    /// \brief Registers the buffer of a thread on first use and writes whatever is left in it when the thread exits
+    class LocalThreadBuffer
+    {
+    public:
+        LocalThreadBuffer()
+        {
+            threadBuffers.add(buffer_);
+        }
+
+        LocalThreadBuffer(const LocalThreadBuffer&) = delete;
+        LocalThreadBuffer(LocalThreadBuffer&&) = delete;
+
+        LocalThreadBuffer& operator=(const LocalThreadBuffer&) = delete;
+        LocalThreadBuffer& operator=(LocalThreadBuffer&&) = delete;
+
+        ~LocalThreadBuffer() noexcept
+        {
+            threadBuffers.remove(buffer_);
+            buffer_.flush();
+        }
+
+        [[nodiscard]] ThreadBuffer& get() noexcept
+        {
+            return buffer_;
+        }
+
+    private:
+        ThreadBuffer buffer_;
+    };
+
+    static thread_local LocalThreadBuffer localThreadBuffer;
+
+    /// \brief Hand every record that is still in a binary ring, a thread buffer or the asynchronous queue to the sinks
+    static void writeOutstandingRecords() noexcept
     {
-        return levelLabels.at(static_cast<size_t>(currentLevel));
+        details::drainBinaryLog();
+        threadBuffers.flushAll();
+        asyncWriter.drain();
     }
 
-    std::string_view getLogColor()
+    void details::writePendingRecords(int fd) noexcept
     {
-        return doColor ? cols.at(static_cast<size_t>(currentLevel)) : "";
+        //the queue holds the older records, thread buffers are only handed to it when they are full or flushed
+        asyncWriter.writePending(fd);
+        threadBuffers.writePending(fd);
+    }
+
+    /// \brief Publish a copy of the current style with one setting replaced
+    template <typename F>
+    static void updateStyle(F&& update) noexcept
+    {
+        std::lock_guard lock{styleMtx};
+        try {
+            auto style = std::make_unique<RecordStyle>(*currentStyle.load(std::memory_order_relaxed));
+            update(*style);
+            //kept alive before it is published, readers may use it as soon as the store is done
+            styleSnapshots.push_back(std::move(style));
+            currentStyle.store(styleSnapshots.back().get(), std::memory_order_release);
+        } catch (...) {
+            //out of memory, keep the current style
+        }
     }
 
     namespace details {
 
-        LogLevel requiredLevel() noexcept
+        std::string& messageBuffer() noexcept
         {
-            return minLogLevel;
+            return messageBuf;
         }
 
-        void setLogLevel(LogLevel level) noexcept
+        std::string& structuredFields() noexcept
         {
-            currentLevel = level;
+            return fieldsBuf;
         }
 
-//TODO: why does MSVC accept this?
-//We disable -Wsign-conversion here because std::string_view::size() returns an unsigned std::size_t
-//but std::ostream::write() takes a std::streamsize which is signed. We cannot do anything about that :(
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wsign-conversion"
+        std::string* retargetMessageStream(std::string* target) noexcept
+        {
+            return messageStreamBuf.retarget(target);
+        }
 
-        void printWithoutLabel(std::string_view msg) noexcept
+        std::ostream& messageStream() noexcept
         {
-            if (doColor) {
-                const auto col = getLogColor();
-                outStream.write(col.data(), col.size()).write(msg.data(), msg.size()).write(reset_col.data(), reset_col.size());
+            //user-defined operator<< might have changed the formatting state of the last object
+            messageOStream.flags(std::ios_base::skipws | std::ios_base::dec);
+            messageOStream.precision(6);
+            messageOStream.width(0);
+            messageOStream.fill(' ');
+            messageOStream.clear();
+
+            return messageOStream;
+        }
+
+        bool isTraceEnabled(std::uint64_t trace_id) noexcept
+        {
+            const auto* traces = enabledTraces.load(std::memory_order_acquire);
+            return traces != nullptr && std::binary_search(traces->begin(), traces->end(), trace_id);
+        }
+
+        RecordMarker beginRecord(std::string& buffer, const ChannelState& channel, LogLevel level, bool with_label) noexcept
+        {
+            return beginRecordAt(buffer, channel, level, with_label, timestampNow());
+        }
+
+        RecordMarker beginRecordAt(
+            std::string& buffer, const ChannelState& channel, LogLevel level, bool with_label, RecordTimestamp timestamp) noexcept
+        {
+            const auto& style = *currentStyle.load(std::memory_order_acquire);
+            const auto index = static_cast<std::size_t>(level);
+
+            const auto color = style.colors[index];
+            const auto format = style.format;
+            RecordMarker marker{buffer.size(), level, color.size(), channel.sinks, format, 0, fieldsBuf.size()};
+
+            buffer.append(color);
+            if (format == RecordFormat::text) {
+                appendTimestamp(buffer, timestamp);
+                if (with_label) {
+                    buffer.append("[").append(style.labels[index]).append("] ");
+                }
             } else {
-                outStream.write(msg.data(), msg.size());
+                beginStructuredRecord(buffer, format, timestamp, with_label ? style.labels[index] : std::string_view{});
             }
+            marker.message_start = buffer.size();
+
+            return marker;
         }
 
-        void print(std::string_view msg) noexcept
+        void endRecord(std::string& buffer, RecordMarker marker)
         {
-            if (doColor) {
-                const auto col = getLogColor();
-                const auto label = getLogLabel();
+            if (marker.format != RecordFormat::text || fieldsBuf.size() != marker.fields_start) {
+                const auto fields = std::string_view{fieldsBuf}.substr(marker.fields_start);
+                finishStructuredRecord(buffer, marker.message_start, fields, marker.format);
+                fieldsBuf.resize(marker.fields_start);
+            }
 
-                outStream.write(col.data(), col.size())
-                    .write("[", 1)
-                    .write(label.data(), label.size())
-                    .write("] ", 2)
-                    .write(reset_col.data(), reset_col.size());
-            } else {
-                const auto label = getLogLabel();
+            if (marker.color_size != 0) {
+                buffer.append(details::reset_col);
+            }
+
+            bump(threadStats().emitted[static_cast<std::size_t>(marker.level)]); //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
 
-                outStream.write("[", 1).write(label.data(), label.size()).write("] ", 2);
+            //the process is probably about to go down, so everything buffered is written before fatal() returns. Records
+            //that are still in binary rings are older and have to be written first
+            const bool is_fatal = marker.level == LogLevel::fatal;
+            if (is_fatal) {
+                flush();
+            }
+
+            //taken after the flush, which can run nested log calls that grow (and reallocate) buffer
+            const auto record = std::string_view{buffer}.substr(marker.start);
+            const RecordInfo info{
+                static_cast<std::uint32_t>(record.size()), static_cast<std::uint32_t>(marker.color_size), marker.level, marker.sinks};
+
+            //checked first so threads do not register a buffer while buffering is disabled
+            if (!threadBuffers.enabled() || !threadBuffers.append(localThreadBuffer.get(), record, info)) {
+                submit(record, &info, 1);
             }
-            printWithoutLabel(msg);
-        }
 
-#pragma GCC diagnostic pop
+            buffer.resize(marker.start);
+
+            if (is_fatal) {
+                flush();
+            }
+        }
 
         void lockStream()
         {
+            if (mtx.try_lock()) {
+                return;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
             mtx.lock();
-            mtx_engaged = true;
+
+            auto& counters = threadStats();
+            bump(counters.lock_contentions);
+            bump(counters.lock_wait_ns, nanosecondsSince(start));
         }
 
         void unlockStream() noexcept
         {
-            if (mtx_engaged) {
-                mtx_engaged = false;
-                mtx.unlock();
-            }
+            mtx.unlock();
         }
 
     } // namespace details
 
     void setLogLabel(LogLevel lv, std::string_view label) noexcept
     {
-        RAYCHELLOGGER_LOCK_STREAM();
-
-        levelLabels.at(static_cast<size_t>(lv)) = label;
+        updateStyle([lv, label](RecordStyle& style) {
+            style.labels.at(static_cast<std::size_t>(lv)) = styleText.emplace_back(label);
+        });
     }
 
     void setLogColor(LogLevel lv, std::string_view color) noexcept
     {
-        RAYCHELLOGGER_LOCK_STREAM();
+        updateStyle([lv, color](RecordStyle& style) {
+            style.colors.at(static_cast<std::size_t>(lv)) = styleText.emplace_back(color);
+        });
+    }
 
-        cols.at(static_cast<size_t>(lv)) = color;
+    void setRecordFormat(RecordFormat format) noexcept
+    {
+        updateStyle([format](RecordStyle& style) { style.format = format; });
     }
 
     void setOutStream(std::ostream& os)
     {
-        RAYCHELLOGGER_LOCK_STREAM();
-        outStream.rdbuf(os.rdbuf());
+        defaultChannel().setOutStream(os);
+    }
+
+    void enableAsync(std::size_t queue_capacity, OverflowPolicy policy)
+    {
+        asyncWriter.start(queue_capacity, policy);
+    }
+
+    void disableAsync() noexcept
+    {
+        asyncWriter.stop();
+    }
+
+    void enableThreadBuffering(std::size_t buffer_size, std::chrono::milliseconds flush_interval)
+    {
+        threadBuffers.enable(buffer_size, flush_interval);
+    }
+
+    void disableThreadBuffering() noexcept
+    {
+        threadBuffers.disable();
+    }
+
+    std::size_t droppedRecords() noexcept
+    {
+        return asyncWriter.dropped();
+    }
+
+    LoggerStats stats() noexcept
+    {
+        LoggerStats result;
+        details::sumThreadStats(result);
+        asyncWriter.queueStats(result);
+        result.dropped = asyncWriter.dropped();
+        result.network_dropped = details::networkDropped();
+        result.binary_dropped = details::binaryDropped();
+        return result;
     }
 
     void disableColor() noexcept
     {
-        doColor = false;
+        sinks.setColor(primary_sink, false);
     }
 
     void enableColor() noexcept
     {
-        doColor = true;
+        sinks.setColor(primary_sink, true);
     }
 
     std::string startTimer(std::string_view label) noexcept
     {
-        RAYCHELLOGGER_LOCK_STREAM();
-        const auto tp = std::chrono::high_resolution_clock::now();
+        const auto timer = startTimer();
 
         std::string str{label};
-        timePoints.insert_or_assign(str, tp);
+        std::lock_guard lock{timerMtx};
+        timers.insert_or_assign(str, timer);
         return str;
     }
 
     std::chrono::nanoseconds details::endTimer(const std::string& label) noexcept
     {
-        using namespace std::chrono;
+        const auto end_point = std::chrono::high_resolution_clock::now();
 
-        RAYCHELLOGGER_LOCK_STREAM();
+        std::unique_lock lock{timerMtx};
+        const auto node = timers.extract(label);
+        lock.unlock();
 
-        const auto endPoint = high_resolution_clock::now();
-        if (timePoints.find(label) != timePoints.end()) {
-            const auto startTime = timePoints.extract(label).mapped();
-            return duration_cast<std::chrono::nanoseconds>(endPoint - startTime);
+        if (node.empty()) {
+            error("Label ", label, " not found!\n");
+            return std::chrono::nanoseconds{-1};
         }
-
-        error("Label ", label, " not found!\n");
-        return std::chrono::nanoseconds{-1};
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end_point - node.mapped().start);
     }
 
     std::chrono::nanoseconds details::getTimer(const std::string& label) noexcept
     {
-        using namespace std::chrono;
+        const auto end_point = std::chrono::high_resolution_clock::now();
 
-        RAYCHELLOGGER_LOCK_STREAM();
-
-        const auto endPoint = high_resolution_clock::now();
-        if (timePoints.find(label) != timePoints.end()) {
-            const auto startTime = timePoints.at(label);
-            return duration_cast<std::chrono::nanoseconds>(endPoint - startTime);
+        std::unique_lock lock{timerMtx};
+        const auto it = timers.find(label);
+        if (it == timers.end()) {
+            lock.unlock();
+            error("Label ", label, " not found!\n");
+            return std::chrono::nanoseconds{-1};
         }
-        error("Label ", label, " not found!\n");
-        return std::chrono::nanoseconds{-1};
+        const auto timer = it->second;
+        lock.unlock();
+
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end_point - timer.start);
     }
 
     LogLevel setMinimumLogLevel(LogLevel lv) noexcept
     {
-        minLogLevel = lv;
-        return minLogLevel;
+        return defaultChannel().setMinimumLogLevel(lv);
+    }
+
+    void setSampleRate(LogLevel level, std::uint32_t one_in) noexcept
+    {
+        defaultChannel().setSampleRate(level, one_in);
     }
 
-    void initLogFile(std::string_view directory, std::string_view filename)
+    /// \brief Publish a copy of the enabled traces if update changed it. Returns what update returned
+    template <typename F>
+    static bool updateTraces(F&& update)
+    {
+        std::lock_guard lock{traceMtx};
+        const auto* current = enabledTraces.load(std::memory_order_relaxed);
+        auto traces = current != nullptr ? std::make_unique<TraceList>(*current) : std::make_unique<TraceList>();
+        if (!update(*traces)) {
+            return false;
+        }
+
+        //reserved first so nothing can throw once the new list is visible
+        traceSnapshots.reserve(traceSnapshots.size() + 1);
+        enabledTraces.store(traces.get(), std::memory_order_release);
+        traceSnapshots.push_back(std::move(traces));
+        return true;
+    }
+
+    void enableTrace(std::uint64_t trace_id)
+    {
+        updateTraces([trace_id](TraceList& traces) {
+            const auto it = std::lower_bound(traces.begin(), traces.end(), trace_id);
+            if (it != traces.end() && *it == trace_id) {
+                return false;
+            }
+            traces.insert(it, trace_id);
+            return true;
+        });
+    }
+
+    bool disableTrace(std::uint64_t trace_id)
+    {
+        return updateTraces([trace_id](TraceList& traces) {
+            const auto it = std::lower_bound(traces.begin(), traces.end(), trace_id);
+            if (it == traces.end() || *it != trace_id) {
+                return false;
+            }
+            traces.erase(it);
+            return true;
+        });
+    }
+
+    void initLogFile(std::string_view directory, std::string_view filename, const FileSinkOptions& options)
     {
         const fs::path dir{directory};
         if (!directory.empty()) {
@@ -232,27 +918,153 @@ namespace Logger {
             }
         }
 
-        if (logFile.is_open()) {
-            dumpLogFile();
+        //records logged before belong to the old output
+        dumpLogFile();
+
+        const auto path = (dir / filename).string();
+        if (sinks.openPrimaryFile(path, options)) {
+            //a mapped file already has its full size, records appended behind it would be separated by a gap
+            details::setCrashLogPath(options.memory_mapped ? std::string_view{} : std::string_view{path});
+            disableColor();
         }
+    }
 
-        const auto filepath = dir / filename;
+    void dumpLogFile() noexcept
+    {
+        writeOutstandingRecords();
 
-        logFile = std::ofstream{filepath};
+        details::setCrashLogPath({});
+        sinks.closePrimaryFile();
+    }
 
-        if (logFile.is_open()) {
-            outStream.rdbuf(logFile.rdbuf());
-            disableColor();
+    void flush() noexcept
+    {
+        writeOutstandingRecords();
+
+        sinks.flush();
+
+        std::lock_guard lock{channelsMtx};
+        for (const auto& [name, instance] : channels) {
+            instance->state().sinks->flush();
         }
     }
 
-    void dumpLogFile() noexcept
+    SinkId addSink(std::ostream& os, const SinkOptions& options)
+    {
+        return defaultChannel().addSink(os, options);
+    }
+
+    std::optional<SinkId> addFileSink(
+        std::string_view directory, std::string_view fileName, const SinkOptions& options, const FileSinkOptions& file_options)
+    {
+        return defaultChannel().addFileSink(directory, fileName, options, file_options);
+    }
+
+    std::optional<SinkId> addNetworkSink(
+        std::string_view host, std::uint16_t port, const SinkOptions& options, const NetworkSinkOptions& network_options)
+    {
+        return defaultChannel().addNetworkSink(host, port, options, network_options);
+    }
+
+    bool removeSink(SinkId id)
+    {
+        return defaultChannel().removeSink(id);
+    }
+
+    bool setSinkOptions(SinkId id, const SinkOptions& options) noexcept
+    {
+        return defaultChannel().setSinkOptions(id, options);
+    }
+
+    Channel::Channel(std::string name)
+        : name_{std::move(name)}, ownSinks_{std::make_unique<details::SinkRegistry>()}, state_{ownState_}
+    {
+        state_.sinks = ownSinks_.get();
+    }
+
+    Channel::Channel(std::string name, details::SinkRegistry& existing_sinks) noexcept : name_{std::move(name)}, state_{ownState_}
+    {
+        state_.sinks = &existing_sinks;
+    }
+
+    Channel::Channel(std::string name, details::SinkRegistry& existing_sinks, details::ChannelState& state) noexcept
+        : name_{std::move(name)}, state_{state}
+    {
+        state_.sinks = &existing_sinks;
+    }
+
+    Channel::~Channel() noexcept = default;
+
+    void Channel::setOutStream(std::ostream& os)
+    {
+        //buffered records still belong to the old stream
+        writeOutstandingRecords();
+        state_.sinks->setPrimaryStream(os.rdbuf());
+    }
+
+    SinkId Channel::addSink(std::ostream& os, const SinkOptions& options)
     {
-        if (logFile.is_open()) {
-            if (outStream.rdbuf() == logFile.rdbuf()) {
-                outStream.rdbuf(std::cout.rdbuf());
+        return state_.sinks->add(os, options);
+    }
+
+    std::optional<SinkId> Channel::addFileSink(
+        std::string_view directory, std::string_view fileName, const SinkOptions& options, const FileSinkOptions& file_options)
+    {
+        const fs::path dir{directory};
+        if (!directory.empty()) {
+            std::error_code ec;
+            fs::create_directories(dir, ec);
+            if (ec) {
+                error("failed to open log file '", directory, "/", fileName, "': ", ec.message(), '\n');
+                return std::nullopt;
             }
-            logFile.close();
         }
+
+        return state_.sinks->addFile((dir / fileName).string(), options, file_options);
+    }
+
+    std::optional<SinkId> Channel::addNetworkSink(
+        std::string_view host, std::uint16_t port, const SinkOptions& options, const NetworkSinkOptions& network_options)
+    {
+        return state_.sinks->addNetwork(std::string{host}, port, options, network_options);
+    }
+
+    bool Channel::removeSink(SinkId id)
+    {
+        //records logged before belong to the sink as well
+        writeOutstandingRecords();
+        return state_.sinks->remove(id);
+    }
+
+    bool Channel::setSinkOptions(SinkId id, const SinkOptions& options) noexcept
+    {
+        return state_.sinks->setOptions(id, options);
+    }
+
+    void Channel::flush() noexcept
+    {
+        writeOutstandingRecords();
+        state_.sinks->flush();
+    }
+
+    Channel& channel(std::string_view name)
+    {
+        if (name == defaultChannel().name()) {
+            return defaultChannel();
+        }
+
+        std::lock_guard lock{channelsMtx};
+        if (const auto it = channels.find(name); it != channels.end()) {
+            return *it->second;
+        }
+        auto& instance = channels[std::string{name}];
+        instance.reset(new Channel{std::string{name}}); //NOLINT(cppcoreguidelines-owning-memory)
+        return *instance;
+    }
+
+    Channel& defaultChannel() noexcept
+    {
+        static Channel instance{"default", sinks, details::defaultState};
+        return instance;
     }
 } // namespace Logger
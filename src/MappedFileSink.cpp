@@ -0,0 +1,337 @@
+/**
+*\file MappedFileSink.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Log file that records are copied into through a memory mapping
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+#include "MappedFileSink.h"
+#include "Stats.h"
+
+#if __has_include(<filesystem>)
+    #include <filesystem>
+namespace fs = std::filesystem;
+#else
+    #include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#if RAYCHELLOGGER_HAS_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace Logger::details {
+
+    constexpr std::size_t no_end = std::numeric_limits<std::size_t>::max();
+
+    bool MappedFileSink::open(const std::string& path, const FileSinkOptions& options)
+    {
+        close();
+
+        std::lock_guard lock{rollMtx_};
+        path_ = path;
+        nextPath_ = path + ".next";
+        size_ = std::max<std::size_t>(options.mapped_size, 4096);
+        maxFiles_ = options.rotation.max_files;
+
+        auto* mapping = map(path_, size_);
+        if (mapping == nullptr) {
+            return false;
+        }
+
+        //the worker maps the next file right away, so the first rollover does not have to wait for it
+        stopRequested_ = false;
+        nextRequested_ = true;
+        nextFailed_ = false;
+        try {
+            worker_ = std::thread{[this] { run(); }};
+        } catch (...) {
+            unmap(mapping);
+            throw;
+        }
+
+        current_.store(mapping, std::memory_order_seq_cst);
+        return true;
+    }
+
+    void MappedFileSink::write(std::string_view records) noexcept
+    {
+        if (records.empty()) {
+            return;
+        }
+
+        while (true) {
+            auto* mapping = current_.load(std::memory_order_seq_cst);
+            if (mapping == nullptr) {
+                bump(threadStats().file_dropped);
+                return;
+            }
+
+            //pin the mapping, the worker waits for all pins before it unmaps
+            mapping->writers.fetch_add(1, std::memory_order_seq_cst);
+            if (current_.load(std::memory_order_seq_cst) != mapping) {
+                mapping->writers.fetch_sub(1, std::memory_order_release);
+                continue;
+            }
+
+            const auto offset = mapping->offset.fetch_add(records.size(), std::memory_order_relaxed);
+            if (offset + records.size() <= mapping->size) {
+                std::memcpy(mapping->data + offset, records.data(), records.size()); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                mapping->writers.fetch_sub(1, std::memory_order_release);
+                return;
+            }
+
+            //only the first reservation that does not fit can start inside the mapping, everything after it starts behind the end
+            if (offset <= mapping->size) {
+                mapping->end.store(offset, std::memory_order_relaxed);
+            }
+
+            //the pin is held until the mapping is replaced, otherwise it could already be unmapped and its address reused
+            //for the next one. Only the retired mapping is waited for, so this cannot block the worker
+            const bool too_large = records.size() > mapping->size; //would not fit into a new file either
+            const bool rolled_over = !too_large && rollOver(mapping);
+            mapping->writers.fetch_sub(1, std::memory_order_release);
+
+            if (!rolled_over) {
+                bump(threadStats().file_dropped);
+                return;
+            }
+        }
+    }
+
+    void MappedFileSink::flush() noexcept
+    {
+#if RAYCHELLOGGER_HAS_MMAP
+        std::lock_guard lock{rollMtx_};
+        if (auto* mapping = current_.load(std::memory_order_seq_cst); mapping != nullptr) {
+            ::msync(mapping->data, std::min(mapping->offset.load(std::memory_order_relaxed), mapping->size), MS_ASYNC);
+        }
+#endif
+    }
+
+    void MappedFileSink::close() noexcept
+    {
+        stopWorker();
+
+        std::unique_lock lock{rollMtx_};
+        if (retired_ != nullptr) {
+            retire(lock); //a writer rolled over while the worker was stopping
+        }
+        auto* current = current_.exchange(nullptr, std::memory_order_seq_cst);
+        auto* next = std::exchange(next_, nullptr);
+        lock.unlock();
+
+        //writers that are still pinned in rollOver() need the lock to notice the mapping is gone
+        unmap(current);
+        if (next != nullptr) {
+            unmap(next);
+            std::remove(nextPath_.c_str());
+        }
+    }
+
+    MappedFileSink::Mapping* MappedFileSink::map([[maybe_unused]] const std::string& path, [[maybe_unused]] std::size_t size) noexcept
+    {
+#if RAYCHELLOGGER_HAS_MMAP
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644); //NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        if (fd < 0) {
+            return nullptr;
+        }
+
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) { //NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+            ::close(fd);
+            return nullptr;
+        }
+
+        auto* mapping = new (std::nothrow) Mapping{}; //NOLINT(cppcoreguidelines-owning-memory)
+        if (mapping == nullptr) {
+            ::munmap(data, size);
+            ::close(fd);
+            return nullptr;
+        }
+
+        mapping->fd = fd;
+        mapping->data = static_cast<char*>(data);
+        mapping->size = size;
+        mapping->end.store(no_end, std::memory_order_relaxed);
+        return mapping;
+#else
+        return nullptr;
+#endif
+    }
+
+    void MappedFileSink::unmap(Mapping* mapping) noexcept
+    {
+        if (mapping == nullptr) {
+            return;
+        }
+
+        while (mapping->writers.load(std::memory_order_seq_cst) != 0) {
+            std::this_thread::yield();
+        }
+
+#if RAYCHELLOGGER_HAS_MMAP
+        const auto end = mapping->end.load(std::memory_order_relaxed);
+        const auto used = end == no_end ? std::min(mapping->offset.load(std::memory_order_relaxed), mapping->size) : end;
+
+        ::munmap(mapping->data, mapping->size);
+        //the file was created at its full size, so the part nobody wrote to is cut off again
+        [[maybe_unused]] const auto result = ::ftruncate(mapping->fd, static_cast<off_t>(used));
+        ::close(mapping->fd);
+#endif
+        delete mapping; //NOLINT(cppcoreguidelines-owning-memory)
+    }
+
+    bool MappedFileSink::rollOver(Mapping* full) noexcept
+    {
+        std::unique_lock lock{rollMtx_};
+        if (next_ == nullptr && current_.load(std::memory_order_seq_cst) == full && !stopRequested_) {
+            //the worker is still busy with the previous file, or it could not map the next one and has to try again
+            nextRequested_ = true;
+            nextFailed_ = false;
+            wakeup_.notify_one();
+            nextReady_.wait(lock, [this, full] {
+                return next_ != nullptr || current_.load(std::memory_order_seq_cst) != full || nextFailed_ || stopRequested_;
+            });
+        }
+
+        if (current_.load(std::memory_order_seq_cst) != full) {
+            return true; //another writer was faster
+        }
+        if (next_ == nullptr) {
+            return false;
+        }
+
+        retired_ = full;
+        current_.store(std::exchange(next_, nullptr), std::memory_order_seq_cst);
+        nextRequested_ = true;
+        wakeup_.notify_one();
+        return true;
+    }
+
+    void MappedFileSink::run() noexcept
+    {
+        std::unique_lock lock{rollMtx_};
+        while (true) {
+            wakeup_.wait(lock, [this] { return stopRequested_ || retired_ != nullptr || (next_ == nullptr && nextRequested_); });
+
+            if (retired_ != nullptr) {
+                retire(lock);
+            }
+            if (stopRequested_) {
+                break;
+            }
+
+            if (next_ == nullptr && nextRequested_) {
+                nextRequested_ = false;
+                lock.unlock();
+                auto* mapping = map(nextPath_, size_);
+                lock.lock();
+
+                next_ = mapping;
+                nextFailed_ = mapping == nullptr;
+                nextReady_.notify_all();
+            }
+        }
+    }
+
+    void MappedFileSink::retire(std::unique_lock<std::mutex>& lock) noexcept
+    {
+        auto* full = std::exchange(retired_, nullptr);
+        lock.unlock();
+
+        unmap(full); //waits for the writers that are still copying into it
+        shiftRotatedFiles();
+        //writers already use the file that replaced it, it only gets its final name now
+        if (std::rename(nextPath_.c_str(), path_.c_str()) != 0) {
+            bump(threadStats().file_errors);
+        }
+
+        lock.lock();
+    }
+
+    void MappedFileSink::shiftRotatedFiles() const noexcept
+    {
+        //a missing file is not an error, most of the names do not exist until the sink has rotated max_files times
+        const auto count_error = [](const std::error_code& ec) {
+            if (ec && ec != std::errc::no_such_file_or_directory) {
+                bump(threadStats().file_errors);
+            }
+        };
+
+        try {
+            std::error_code ec;
+            if (maxFiles_ == 0) {
+                fs::remove(path_, ec);
+                count_error(ec);
+                return;
+            }
+
+            fs::remove(rotatedName(maxFiles_), ec);
+            count_error(ec);
+            for (auto i = maxFiles_ - 1; i > 0; i--) {
+                fs::rename(rotatedName(i), rotatedName(i + 1), ec);
+                count_error(ec);
+            }
+            fs::rename(path_, rotatedName(1), ec);
+            count_error(ec);
+        } catch (const std::bad_alloc&) {
+            bump(threadStats().file_errors); //no memory for the names, the files stay where they are
+        }
+    }
+
+    std::string MappedFileSink::rotatedName(std::size_t index) const
+    {
+        return path_ + '.' + std::to_string(index);
+    }
+
+    void MappedFileSink::stopWorker() noexcept
+    {
+        {
+            std::lock_guard lock{rollMtx_};
+            if (!worker_.joinable()) {
+                return;
+            }
+            stopRequested_ = true;
+        }
+        wakeup_.notify_one();
+        nextReady_.notify_all();
+        worker_.join();
+    }
+
+} // namespace Logger::details
@@ -0,0 +1,145 @@
+/**
+*\file MappedFileSink.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Log file that records are copied into through a memory mapping
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef MAPPEDFILESINK_H_
+#define MAPPEDFILESINK_H_
+
+#include "RaychelLogger/Logger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#if __has_include(<sys/mman.h>)
+    #define RAYCHELLOGGER_HAS_MMAP 1
+#else
+    #define RAYCHELLOGGER_HAS_MMAP 0
+#endif
+
+namespace Logger::details {
+
+    /**
+    * \brief Log file of a fixed size that is mapped into memory. Writers reserve their range with a single fetch_add and
+    * copy the record into the mapping, the operating system writes the pages back on its own, even if the process crashes.
+    * A worker thread maps the next file ahead of time, so when the file is full writers only swap it in. The worker then
+    * unmaps the full file and rotates it like a FileSink
+    */
+    class MappedFileSink
+    {
+    public:
+        MappedFileSink() = default;
+
+        MappedFileSink(const MappedFileSink&) = delete;
+        MappedFileSink(MappedFileSink&&) = delete;
+
+        MappedFileSink& operator=(const MappedFileSink&) = delete;
+        MappedFileSink& operator=(MappedFileSink&&) = delete;
+
+        ~MappedFileSink() noexcept
+        {
+            close();
+        }
+
+        /**
+        * \brief Create and map a new log file. Existing files are truncated. The next file is mapped as "<path>.next"
+        * 
+        * \param path Path to the log file
+        * \param options mapped_size is the size of every file, rotation.max_files the number of full files that are kept
+        * \return true if the file could be created and mapped
+        */
+        [[nodiscard]] bool open(const std::string& path, const FileSinkOptions& options);
+
+        /**
+        * \brief Copy records into the mapping. Records larger than the whole file are dropped, as are records written while
+        * the next file cannot be created. Every write into the full file asks the worker to try again. Both count as file_dropped
+        */
+        void write(std::string_view records) noexcept;
+
+        /**
+        * \brief Ask the operating system to start writing the mapping back. Does not wait for it
+        */
+        void flush() noexcept;
+
+        /**
+        * \brief Unmap the file and cut off its unused end
+        */
+        void close() noexcept;
+
+    private:
+        struct Mapping
+        {
+            int fd{-1};
+            char* data{nullptr};
+            std::size_t size{0};
+
+            std::atomic<std::size_t> offset{0}; //next free byte, may run past size
+            std::atomic<std::size_t> end{0};    //offset of the first reservation that did not fit, set by map()
+            std::atomic<std::size_t> writers{0};
+        };
+
+        [[nodiscard]] static Mapping* map(const std::string& path, std::size_t size) noexcept;
+
+        static void unmap(Mapping* mapping) noexcept;
+
+        /// \brief Replace full with the next mapping unless another writer already did. Returns false if there is none
+        [[nodiscard]] bool rollOver(Mapping* full) noexcept;
+
+        void run() noexcept;
+
+        /// \brief Unmap the mapping that was replaced and move the files along. Only the worker and close() call this
+        void retire(std::unique_lock<std::mutex>& lock) noexcept;
+
+        void shiftRotatedFiles() const noexcept;
+
+        [[nodiscard]] std::string rotatedName(std::size_t index) const;
+
+        void stopWorker() noexcept;
+
+        std::atomic<Mapping*> current_{nullptr};
+        std::mutex rollMtx_; //only taken to replace a full mapping and to close
+        Mapping* next_{nullptr}; //mapped at nextPath_ by the worker, guarded by rollMtx_
+        Mapping* retired_{nullptr}; //replaced by next_, waits for the worker to unmap it, guarded by rollMtx_
+        bool nextRequested_{false};
+        bool nextFailed_{false}; //the worker could not map the requested file
+        std::string path_;
+        std::string nextPath_;
+        std::size_t size_{0};
+        std::size_t maxFiles_{0};
+
+        std::thread worker_;
+        std::condition_variable wakeup_;
+        std::condition_variable nextReady_;
+        bool stopRequested_{false};
+    };
+
+} // namespace Logger::details
+
+#endif /* MAPPEDFILESINK_H_ */
@@ -0,0 +1,423 @@
+/**
+*\file NetworkSink.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Buffered, non-blocking output to a log collector
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+
+#include "NetworkSink.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+
+#if RAYCHELLOGGER_HAS_SOCKETS
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace Logger::details {
+
+    static std::atomic<std::uint64_t> droppedRecords{0};
+
+    //how long a single connect or send may take while the sink is not being closed
+    constexpr auto io_timeout = std::chrono::seconds{1};
+
+    std::uint64_t networkDropped() noexcept
+    {
+        return droppedRecords.load(std::memory_order_relaxed);
+    }
+
+    /// \brief Syslog severity of level (RFC 5424, section 6.2.1)
+    [[nodiscard]] static int syslogSeverity(LogLevel level) noexcept
+    {
+        switch (level) {
+            case LogLevel::debug:
+                return 7;
+            case LogLevel::info:
+                return 6;
+            case LogLevel::warn:
+                return 4;
+            case LogLevel::error:
+                return 3;
+            case LogLevel::critical:
+                return 2;
+            case LogLevel::fatal:
+                return 1;
+            case LogLevel::log:
+                return 5;
+        }
+        return 6;
+    }
+
+#if RAYCHELLOGGER_HAS_SOCKETS
+
+    enum class Readiness { ready, timeout, failed };
+
+    [[nodiscard]] static Readiness waitWritable(int fd, std::chrono::steady_clock::time_point deadline) noexcept
+    {
+        while (true) {
+            const auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                return Readiness::timeout;
+            }
+
+            pollfd target{fd, POLLOUT, 0};
+            const int ready = ::poll(&target, 1, static_cast<int>(std::min<long long>(remaining, INT_MAX)));
+            if (ready < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ready == 0) {
+                return Readiness::timeout;
+            }
+
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (ready < 0 || ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0) {
+                return Readiness::failed;
+            }
+            return Readiness::ready;
+        }
+    }
+
+    #ifdef MSG_NOSIGNAL
+    constexpr int send_flags = MSG_NOSIGNAL;
+    #else
+    constexpr int send_flags = 0; //SO_NOSIGPIPE is set on the socket instead
+    #endif
+
+#endif
+
+    bool NetworkSink::open(std::string host, std::uint16_t port, const NetworkSinkOptions& options)
+    {
+#if RAYCHELLOGGER_HAS_SOCKETS
+        close();
+
+        std::lock_guard lock{mtx_};
+
+        host_ = std::move(host);
+        port_ = port;
+        options_ = options;
+        options_.min_backoff = std::max(options_.min_backoff, std::chrono::milliseconds{1});
+        options_.max_backoff = std::max(options_.max_backoff, options_.min_backoff);
+
+        std::array<char, 256> name{};
+        hostname_ = ::gethostname(name.data(), name.size() - 1) == 0 && name[0] != '\0' ? name.data() : "-";
+        procid_ = std::to_string(::getpid());
+
+        buffer_.clear();
+        sizes_.clear();
+        sending_.clear();
+        sendingSizes_.clear();
+        sent_ = 0;
+        sentRecords_ = 0;
+        sendingSize_ = 0;
+        wakeRequested_ = false;
+        stopRequested_ = false;
+        open_ = true;
+
+        worker_ = std::thread{[this] { run(); }};
+        return true;
+#else
+        static_cast<void>(host);
+        static_cast<void>(port);
+        static_cast<void>(options);
+        return false;
+#endif
+    }
+
+    void NetworkSink::write(std::string_view record, LogLevel level) noexcept
+    {
+        std::lock_guard lock{mtx_};
+        if (!open_) {
+            return;
+        }
+
+        //syslog messages are framed by their datagram or their length, a trailing newline would become part of the message
+        if (options_.syslog) {
+            while (!record.empty() && (record.back() == '\n' || record.back() == '\r')) {
+                record.remove_suffix(1);
+            }
+        }
+
+        const auto start = buffer_.size();
+        try {
+            if (options_.syslog) {
+                appendSyslogHeader(level, record.size());
+            }
+            if (bufferedSize() + record.size() > options_.buffer_size) {
+                buffer_.resize(start);
+                droppedRecords.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer_.append(record);
+            sizes_.push_back(static_cast<std::uint32_t>(buffer_.size() - start));
+        } catch (...) {
+            buffer_.resize(start);
+            droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        //the worker is only woken once per batch, everything else waits for the send interval
+        if (start < options_.batch_size && buffer_.size() >= options_.batch_size) {
+            wakeRequested_ = true;
+            wakeup_.notify_one();
+        }
+    }
+
+    void NetworkSink::flush() noexcept
+    {
+        std::lock_guard lock{mtx_};
+        wakeRequested_ = true;
+        wakeup_.notify_one();
+    }
+
+    void NetworkSink::close() noexcept
+    {
+        {
+            std::lock_guard lock{mtx_};
+            if (!worker_.joinable()) {
+                return;
+            }
+            open_ = false;
+            stopRequested_ = true;
+            stopDeadline_ = clock::now() + options_.close_timeout;
+        }
+        wakeup_.notify_one();
+        worker_.join();
+    }
+
+    std::size_t NetworkSink::bufferedSize() const noexcept
+    {
+        return buffer_.size() + sendingSize_;
+    }
+
+    void NetworkSink::appendSyslogHeader(LogLevel level, std::size_t message_size)
+    {
+        constexpr int facility_user = 1;
+
+        header_.clear();
+        header_.append("<").append(std::to_string(facility_user * 8 + syslogSeverity(level))).append(">1 - ");
+        header_.append(hostname_).append(" ").append(options_.app_name.empty() ? "-" : options_.app_name);
+        header_.append(" ").append(procid_).append(" - - ");
+
+        if (options_.protocol == NetworkProtocol::tcp) {
+            buffer_.append(std::to_string(header_.size() + message_size)).append(" ");
+        }
+        buffer_.append(header_);
+    }
+
+    void NetworkSink::run() noexcept
+    {
+        auto backoff = options_.min_backoff;
+
+        std::unique_lock lock{mtx_};
+        while (true) {
+            if (!stopRequested_) {
+                wakeup_.wait_for(lock, options_.send_interval, [this] { return wakeRequested_ || stopRequested_; });
+            }
+            wakeRequested_ = false;
+
+            //a batch that could not be sent completely is finished before the next one is taken
+            if (sent_ == sending_.size()) {
+                sending_.clear();
+                sendingSizes_.clear();
+                sent_ = 0;
+                sentRecords_ = 0;
+                sending_.swap(buffer_);
+                sendingSizes_.swap(sizes_);
+            }
+            sendingSize_ = sending_.size() - sent_;
+
+            const bool stopping = stopRequested_;
+            if (sendingSize_ == 0) {
+                if (stopping) {
+                    break;
+                }
+                continue;
+            }
+
+            const auto deadline = stopping ? stopDeadline_ : clock::now() + io_timeout;
+            lock.unlock();
+            const bool ok = (fd_ >= 0 || connect(deadline)) && sendPending(deadline);
+            if (!ok) {
+                disconnect();
+                rewindPartialRecord();
+            }
+            lock.lock();
+            sendingSize_ = sending_.size() - sent_;
+
+            if (stopping && clock::now() >= stopDeadline_) {
+                break;
+            }
+            if (ok) {
+                backoff = options_.min_backoff;
+                continue;
+            }
+
+            //while closing, the retries have to fit into the close timeout
+            const auto retry = stopping ? std::min(clock::now() + backoff, stopDeadline_) : clock::now() + backoff;
+            wakeup_.wait_until(lock, retry, [this, stopping] { return wakeRequested_ || (stopRequested_ && !stopping); });
+            backoff = std::min(backoff * 2, options_.max_backoff);
+        }
+
+        dropPending();
+        lock.unlock();
+        disconnect();
+    }
+
+    bool NetworkSink::connect([[maybe_unused]] clock::time_point deadline) noexcept
+    {
+#if RAYCHELLOGGER_HAS_SOCKETS
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = options_.protocol == NetworkProtocol::udp ? SOCK_DGRAM : SOCK_STREAM;
+
+        addrinfo* addresses = nullptr;
+        if (::getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &addresses) != 0) {
+            return false;
+        }
+        const auto free_addresses = Finally{[addresses]() noexcept { ::freeaddrinfo(addresses); }};
+
+        for (const auto* address = addresses; address != nullptr; address = address->ai_next) {
+            const int fd = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (fd < 0) {
+                continue;
+            }
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);                             //NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK); //NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    #ifdef SO_NOSIGPIPE
+            const int enable = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+    #endif
+
+            if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0 ||
+                (errno == EINPROGRESS && waitWritable(fd, deadline) == Readiness::ready)) {
+                fd_ = fd;
+                return true;
+            }
+            ::close(fd);
+        }
+#endif
+        return false;
+    }
+
+    bool NetworkSink::sendPending([[maybe_unused]] clock::time_point deadline) noexcept
+    {
+#if RAYCHELLOGGER_HAS_SOCKETS
+        //if the collector is only slow, the connection is kept and the rest is sent the next time
+        if (options_.protocol == NetworkProtocol::tcp) {
+            //the whole batch goes out in as few calls as the socket buffer allows
+            while (sent_ < sending_.size()) {
+                const auto count = ::send(fd_, sending_.data() + sent_, sending_.size() - sent_, send_flags);
+                if (count >= 0) {
+                    sent_ += static_cast<std::size_t>(count);
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    if (const auto readiness = waitWritable(fd_, deadline); readiness != Readiness::ready) {
+                        return readiness == Readiness::timeout;
+                    }
+                } else if (errno != EINTR) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        while (sentRecords_ < sendingSizes_.size()) {
+            const auto size = sendingSizes_[sentRecords_];
+            if (::send(fd_, sending_.data() + sent_, size, send_flags) < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    if (const auto readiness = waitWritable(fd_, deadline); readiness != Readiness::ready) {
+                        return readiness == Readiness::timeout;
+                    }
+                    continue;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno != EMSGSIZE) {
+                    return false;
+                }
+                droppedRecords.fetch_add(1, std::memory_order_relaxed); //too large for a datagram, sending it again will not help
+            }
+            sent_ += size;
+            sentRecords_++;
+        }
+#endif
+        return true;
+    }
+
+    void NetworkSink::disconnect() noexcept
+    {
+#if RAYCHELLOGGER_HAS_SOCKETS
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#endif
+    }
+
+    void NetworkSink::rewindPartialRecord() noexcept
+    {
+        //a new connection has to start with a whole record, or the collector loses the framing of everything after it
+        std::size_t start = 0;
+        std::size_t records = 0;
+        for (const auto size : sendingSizes_) {
+            if (start + size > sent_) {
+                break;
+            }
+            start += size;
+            records++;
+        }
+        sent_ = start;
+        sentRecords_ = records;
+    }
+
+    void NetworkSink::dropPending() noexcept
+    {
+        std::size_t end = 0;
+        std::uint64_t unsent = sizes_.size();
+        for (const auto size : sendingSizes_) {
+            end += size;
+            unsent += end > sent_ ? 1 : 0;
+        }
+        droppedRecords.fetch_add(unsent, std::memory_order_relaxed);
+
+        buffer_.clear();
+        sizes_.clear();
+        sending_.clear();
+        sendingSizes_.clear();
+        sent_ = 0;
+        sentRecords_ = 0;
+        sendingSize_ = 0;
+    }
+
+} // namespace Logger::details
@@ -0,0 +1,152 @@
+/**
+*\file NetworkSink.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Buffered, non-blocking output to a log collector
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef NETWORKSINK_H_
+#define NETWORKSINK_H_
+
+#include "RaychelLogger/Logger.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if __has_include(<sys/socket.h>) && __has_include(<netdb.h>) && __has_include(<poll.h>) && __has_include(<unistd.h>)
+    #define RAYCHELLOGGER_HAS_SOCKETS 1
+#else
+    #define RAYCHELLOGGER_HAS_SOCKETS 0
+#endif
+
+namespace Logger::details {
+
+    /**
+    * \brief Records sent to a log collector by a worker thread. Writers only append to a bounded buffer, the worker
+    * resolves the collector, connects with non-blocking sockets, sends whole batches and reconnects with exponential
+    * backoff. While the collector is down, records stay in the buffer until it is full
+    */
+    class NetworkSink
+    {
+    public:
+        NetworkSink() = default;
+
+        NetworkSink(const NetworkSink&) = delete;
+        NetworkSink(NetworkSink&&) = delete;
+
+        NetworkSink& operator=(const NetworkSink&) = delete;
+        NetworkSink& operator=(NetworkSink&&) = delete;
+
+        ~NetworkSink() noexcept
+        {
+            close();
+        }
+
+        /**
+        * \brief Start the worker thread. Connecting happens on the worker, so an unreachable collector is not an error
+        * 
+        * \return false if this platform has no sockets
+        */
+        [[nodiscard]] bool open(std::string host, std::uint16_t port, const NetworkSinkOptions& options);
+
+        /**
+        * \brief Queue a record for sending. Never waits for the network
+        * 
+        * \param record One complete record
+        * \param level Level of record, used for the syslog priority
+        */
+        void write(std::string_view record, LogLevel level) noexcept;
+
+        /**
+        * \brief Let the worker send everything that is buffered right away. Does not wait for it
+        */
+        void flush() noexcept;
+
+        /**
+        * \brief Send what is still buffered for up to close_timeout, then stop the worker
+        */
+        void close() noexcept;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        [[nodiscard]] std::size_t bufferedSize() const noexcept;
+
+        /// \brief Append the syslog header of a record with level to buffer_
+        void appendSyslogHeader(LogLevel level, std::size_t message_size);
+
+        void run() noexcept;
+
+        /// \brief Resolve the collector and connect to it. Returns false if the deadline passed or every address failed
+        [[nodiscard]] bool connect(clock::time_point deadline) noexcept;
+
+        /// \brief Send as much of sending_ as possible until the deadline. Returns false if the connection broke
+        [[nodiscard]] bool sendPending(clock::time_point deadline) noexcept;
+
+        void disconnect() noexcept;
+
+        /// \brief Move sent_ back to the start of the first record that was not sent completely
+        void rewindPartialRecord() noexcept;
+
+        void dropPending() noexcept;
+
+        mutable std::mutex mtx_;
+        std::condition_variable wakeup_;
+        std::string host_;
+        std::uint16_t port_{0};
+        NetworkSinkOptions options_;
+        std::string hostname_; //syslog HOSTNAME and PROCID, formatted once
+        std::string procid_;
+        std::string header_;
+
+        //filled by writers. sizes_ holds the size of every record, UDP sends them one by one
+        std::string buffer_;
+        std::vector<std::uint32_t> sizes_;
+
+        //only used by the worker. The first sent_ bytes and sentRecords_ records of it have been sent
+        std::string sending_;
+        std::vector<std::uint32_t> sendingSizes_;
+        std::size_t sent_{0};
+        std::size_t sentRecords_{0};
+        std::size_t sendingSize_{0}; //unsent part of sending_, readable by writers
+
+        int fd_{-1};
+        bool open_{false};
+        bool wakeRequested_{false};
+        bool stopRequested_{false};
+        clock::time_point stopDeadline_{};
+        std::thread worker_;
+    };
+
+    /// \brief Records network sinks discarded since the program started
+    [[nodiscard]] std::uint64_t networkDropped() noexcept;
+
+} // namespace Logger::details
+
+#endif /* NETWORKSINK_H_ */
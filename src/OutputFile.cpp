@@ -0,0 +1,156 @@
+/**
+*\file OutputFile.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Unbuffered output file with vectored writes
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+#include "OutputFile.h"
+
+#include <algorithm>
+#include <array>
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace Logger::details {
+
+    void writeFully([[maybe_unused]] int fd, [[maybe_unused]] std::string_view data) noexcept
+    {
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        while (!data.empty()) {
+            const auto written = ::write(fd, data.data(), data.size());
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data.remove_prefix(static_cast<std::size_t>(written));
+        }
+#endif
+    }
+
+    void writeVectored(
+        [[maybe_unused]] int fd,
+        [[maybe_unused]] std::string_view prefix,
+        [[maybe_unused]] const std::string_view* parts,
+        [[maybe_unused]] std::size_t count) noexcept
+    {
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        //IOV_MAX is at least 1024 everywhere we care about
+        constexpr std::size_t max_vectors = 1024;
+        std::array<iovec, max_vectors> vectors{};
+
+        std::size_t next = 0;
+        bool prefix_pending = !prefix.empty();
+        while (prefix_pending || next < count) {
+            std::size_t used = 0;
+            if (prefix_pending) {
+                vectors[used++] = iovec{const_cast<char*>(prefix.data()), prefix.size()}; //NOLINT(cppcoreguidelines-pro-type-const-cast)
+                prefix_pending = false;
+            }
+            for (; used < max_vectors && next < count; next++) {
+                const auto part = parts[next]; //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                if (!part.empty()) {
+                    vectors[used++] = iovec{const_cast<char*>(part.data()), part.size()}; //NOLINT(cppcoreguidelines-pro-type-const-cast)
+                }
+            }
+
+            //on a short write the rest of the batch is written piece by piece
+            std::size_t first = 0;
+            while (first < used) {
+                const auto written = ::writev(fd, &vectors[first], static_cast<int>(used - first));
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return;
+                }
+
+                auto remaining = static_cast<std::size_t>(written);
+                while (first < used && remaining >= vectors[first].iov_len) {
+                    remaining -= vectors[first++].iov_len;
+                }
+                if (first < used) {
+                    vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + remaining; //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                    vectors[first].iov_len -= remaining;
+                }
+            }
+        }
+#endif
+    }
+
+    std::unique_ptr<OutputFile> OutputFile::open(const std::string& path)
+    {
+        std::unique_ptr<OutputFile> file{new OutputFile{}};
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        file->fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644); //NOLINT(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        if (file->fd_ < 0) {
+            return nullptr;
+        }
+#else
+        //we do our own buffering, so the filebuf has to pass everything straight through
+        file->file_.rdbuf()->pubsetbuf(nullptr, 0);
+        file->file_.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+        if (!file->file_.is_open()) {
+            return nullptr;
+        }
+#endif
+        return file;
+    }
+
+    OutputFile::~OutputFile() noexcept
+    {
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        ::close(fd_);
+#endif
+    }
+
+    void OutputFile::write(std::string_view data) noexcept
+    {
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        writeFully(fd_, data);
+#else
+        file_.write(data.data(), static_cast<std::streamsize>(data.size()));
+        file_.flush();
+#endif
+    }
+
+    void OutputFile::write(std::string_view prefix, const std::string_view* parts, std::size_t count) noexcept
+    {
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        writeVectored(fd_, prefix, parts, count);
+#else
+        write(prefix);
+        std::for_each(parts, parts + count, [this](std::string_view part) { write(part); }); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+#endif
+    }
+
+} // namespace Logger::details
@@ -0,0 +1,94 @@
+/**
+*\file OutputFile.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Unbuffered output file with vectored writes
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef OUTPUTFILE_H_
+#define OUTPUTFILE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#if __has_include(<unistd.h>) && __has_include(<fcntl.h>) && __has_include(<sys/uio.h>)
+    #define RAYCHELLOGGER_HAS_POSIX_IO 1
+#else
+    #include <fstream>
+    #define RAYCHELLOGGER_HAS_POSIX_IO 0
+#endif
+
+namespace Logger::details {
+
+    /**
+    * \brief Write data with write(2) until all of it is written or an error occurs. Async-signal-safe
+    */
+    void writeFully(int fd, std::string_view data) noexcept;
+
+    /**
+    * \brief Write prefix followed by parts with as few writev(2) calls as possible. Nothing is copied
+    */
+    void writeVectored(int fd, std::string_view prefix, const std::string_view* parts, std::size_t count) noexcept;
+
+    /**
+    * \brief A file that is written without any buffering of its own. Uses the file descriptor directly where POSIX I/O
+    * is available and an unbuffered std::ofstream everywhere else
+    */
+    class OutputFile
+    {
+    public:
+        /**
+        * \brief Create or truncate the file at path
+        * 
+        * \return nullptr if the file could not be opened
+        */
+        [[nodiscard]] static std::unique_ptr<OutputFile> open(const std::string& path);
+
+        OutputFile(const OutputFile&) = delete;
+        OutputFile(OutputFile&&) = delete;
+
+        OutputFile& operator=(const OutputFile&) = delete;
+        OutputFile& operator=(OutputFile&&) = delete;
+
+        ~OutputFile() noexcept;
+
+        void write(std::string_view data) noexcept;
+
+        /// \brief Write prefix and then every part, in one system call if possible
+        void write(std::string_view prefix, const std::string_view* parts, std::size_t count) noexcept;
+
+    private:
+        OutputFile() = default;
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        int fd_{-1};
+#else
+        std::ofstream file_;
+#endif
+    };
+
+} // namespace Logger::details
+
+#endif /* OUTPUTFILE_H_ */
@@ -0,0 +1,159 @@
+/**
+*\file RecordArena.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Preallocated storage for the text of queued records
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef RECORDARENA_H_
+#define RECORDARENA_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace Logger::details {
+
+    /**
+    * \brief Text storage of a RecordRing. Every slot owns one fixed-size block of a single allocation, which typical
+    * records fit into. Longer records borrow an overflow block from a pool of power-of-two size classes and give it
+    * back once the writer is done with them, so long lines do not allocate either once the pool is warm
+    */
+    class RecordArena
+    {
+    public:
+        static constexpr std::uint8_t no_size_class = 0xFF; //not pooled, allocated and freed directly
+
+        RecordArena(std::size_t blocks, std::size_t block_size)
+            : blockSize_{block_size}, blocks_{std::make_unique<char[]>(blocks * block_size)} //NOLINT(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+        {
+            //reserved up front, so returning a block never allocates. A full queue of records of one size class stays pooled
+            //unless that is more than max_pooled_bytes
+            for (std::uint8_t i = 0; i < size_classes; i++) {
+                pools_[i].reserve(std::min(blocks, std::max<std::size_t>(max_pooled_bytes / classSize(i), 1)));
+            }
+        }
+
+        [[nodiscard]] std::size_t blockSize() const noexcept
+        {
+            return blockSize_;
+        }
+
+        /// \brief The fixed block of slot index
+        [[nodiscard]] char* block(std::size_t index) const noexcept
+        {
+            return blocks_.get() + index * blockSize_; //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+
+        /**
+        * \brief Get storage for a record that does not fit its block
+        * 
+        * \param size Size of the record
+        * \param size_class Receives the value deallocate needs
+        * \return nullptr if out of memory
+        */
+        [[nodiscard]] char* allocate(std::size_t size, std::uint8_t& size_class) noexcept
+        {
+            size_class = sizeClass(size);
+            if (size_class == no_size_class) {
+                return new (std::nothrow) char[size];
+            }
+
+            {
+                std::lock_guard lock{poolMtx_};
+                auto& pool = pools_[size_class];
+                if (!pool.empty()) {
+                    auto* data = pool.back();
+                    pool.pop_back();
+                    return data;
+                }
+            }
+            return new (std::nothrow) char[classSize(size_class)];
+        }
+
+        /// \brief Return storage from allocate to the pool, or free it if the pool of its size class is full
+        void deallocate(char* data, std::uint8_t size_class) noexcept
+        {
+            if (size_class != no_size_class) {
+                std::lock_guard lock{poolMtx_};
+                auto& pool = pools_[size_class];
+                if (pool.size() < pool.capacity()) {
+                    pool.push_back(data);
+                    return;
+                }
+            }
+            delete[] data;
+        }
+
+        RecordArena(const RecordArena&) = delete;
+        RecordArena(RecordArena&&) = delete;
+
+        RecordArena& operator=(const RecordArena&) = delete;
+        RecordArena& operator=(RecordArena&&) = delete;
+
+        ~RecordArena() noexcept
+        {
+            for (auto& pool : pools_) {
+                for (auto* data : pool) {
+                    delete[] data;
+                }
+            }
+        }
+
+    private:
+        static constexpr std::size_t min_class_size = 1024;
+        static constexpr std::size_t size_classes = 11; //1KiB to 1MiB
+        static constexpr std::size_t max_pooled_bytes = 8 * 1024 * 1024; //per size class
+
+        [[nodiscard]] static std::uint8_t sizeClass(std::size_t size) noexcept
+        {
+            std::uint8_t size_class = 0;
+            while (classSize(size_class) < size) {
+                if (++size_class == size_classes) {
+                    return no_size_class;
+                }
+            }
+            return size_class;
+        }
+
+        [[nodiscard]] static constexpr std::size_t classSize(std::uint8_t size_class) noexcept
+        {
+            return min_class_size << size_class;
+        }
+
+        const std::size_t blockSize_;
+        std::unique_ptr<char[]> blocks_; //NOLINT(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+
+        //only locked for records that do not fit their block
+        std::mutex poolMtx_;
+        std::array<std::vector<char*>, size_classes> pools_;
+    };
+
+} // namespace Logger::details
+
+#endif /* RECORDARENA_H_ */
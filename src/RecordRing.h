@@ -0,0 +1,261 @@
+/**
+*\file RecordRing.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Lock-free bounded queue of finished records
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef RECORDRING_H_
+#define RECORDRING_H_
+
+#include "RecordArena.h"
+#include "Sinks.h"
+#include "Stats.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace Logger::details {
+
+    /**
+    * \brief Bounded multi-producer queue of finished records. The slots and their text are allocated up front, so
+    * pushing a record that fits its slot neither locks nor allocates. Longer records are stored in overflow blocks of the
+    * arena. Popping is safe from several threads as well, which lets producers discard the oldest record when the queue
+    * is full
+    */
+    class RecordRing
+    {
+        struct alignas(cache_line_size) Slot
+        {
+            std::atomic<std::uint64_t> sequence{0};
+            RecordInfo info{};
+            char* overflow{nullptr}; //holds the text instead of the fixed block if it did not fit
+            std::uint8_t overflow_class{RecordArena::no_size_class};
+        };
+
+    public:
+        enum class PushResult : std::uint8_t {
+            pushed,
+            full,
+            no_memory, //the record did not fit its slot and no overflow block could be allocated, so it was discarded
+        };
+
+        /**
+        * \param capacity Number of slots. Rounded up to a power of two
+        * \param slot_size Number of bytes reserved for the text of every slot. Longer records use an overflow block
+        */
+        RecordRing(std::size_t capacity, std::size_t slot_size)
+            : mask_{roundUpToPowerOfTwo(capacity) - 1},
+              slots_{std::make_unique<Slot[]>(mask_ + 1)}, //NOLINT(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+              arena_{mask_ + 1, slot_size}
+        {
+            for (std::size_t i = 0; i <= mask_; i++) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        RecordRing(const RecordRing&) = delete;
+        RecordRing(RecordRing&&) = delete;
+
+        RecordRing& operator=(const RecordRing&) = delete;
+        RecordRing& operator=(RecordRing&&) = delete;
+
+        ~RecordRing() noexcept
+        {
+            for (std::size_t i = 0; i <= mask_; i++) {
+                recycle(slots_[i]);
+            }
+        }
+
+        /// \brief Returns PushResult::full if the queue is full
+        [[nodiscard]] PushResult tryPush(std::string_view text, const RecordInfo& info) noexcept
+        {
+            auto pos = enqueuePos_.load(std::memory_order_relaxed);
+            while (true) {
+                auto& slot = slots_[pos & mask_];
+                const auto diff = static_cast<std::int64_t>(slot.sequence.load(std::memory_order_acquire) - pos);
+
+                if (diff == 0) {
+                    if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        const bool stored = store(slot, pos & mask_, text);
+                        slot.info = stored ? info : RecordInfo{0, 0, info.level, info.sinks};
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return stored ? PushResult::pushed : PushResult::no_memory;
+                    }
+                } else if (diff < 0) {
+                    return PushResult::full;
+                } else {
+                    pos = enqueuePos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// \brief Call f with the text and layout of the oldest record and remove it. Returns false if the queue is empty
+        template <typename F>
+        [[nodiscard]] bool tryPop(F&& f) noexcept
+        {
+            return pop<true>(std::forward<F>(f));
+        }
+
+        /// \brief Like tryPop, but overflow blocks are not given back to the arena, which is not async-signal-safe
+        template <typename F>
+        [[nodiscard]] bool tryPopInSignalHandler(F&& f) noexcept
+        {
+            return pop<false>(std::forward<F>(f));
+        }
+
+        /**
+        * \brief Remove up to max of the oldest records at once and call f with their number. Before f is called, the first
+        * texts and infos are filled with views of the records, which stay valid until f returns
+        *
+        * \return Number of records removed. 0 if the queue is empty
+        */
+        template <typename F>
+        [[nodiscard]] std::size_t tryPopBatch(std::string_view* texts, RecordInfo* infos, std::size_t max, F&& f) noexcept
+        {
+            auto pos = dequeuePos_.load(std::memory_order_relaxed);
+            while (true) {
+                std::size_t ready = 0;
+                while (ready < max && slots_[(pos + ready) & mask_].sequence.load(std::memory_order_acquire) == pos + ready + 1) {
+                    ready++;
+                }
+
+                if (ready == 0) {
+                    const auto& slot = slots_[pos & mask_];
+                    if (static_cast<std::int64_t>(slot.sequence.load(std::memory_order_acquire) - (pos + 1)) < 0) {
+                        return 0;
+                    }
+                    pos = dequeuePos_.load(std::memory_order_relaxed);
+                    continue;
+                }
+
+                if (dequeuePos_.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                    for (std::size_t i = 0; i < ready; i++) {
+                        const auto index = (pos + i) & mask_;
+                        texts[i] = text(slots_[index], index); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                        infos[i] = slots_[index].info;         //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+                    }
+                    f(ready);
+                    for (std::size_t i = 0; i < ready; i++) {
+                        auto& slot = slots_[(pos + i) & mask_];
+                        recycle(slot);
+                        slot.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+                    }
+                    return ready;
+                }
+            }
+        }
+
+        /// \brief Number of records pushed since the queue was created
+        [[nodiscard]] std::uint64_t pushed() const noexcept
+        {
+            return enqueuePos_.load(std::memory_order_seq_cst);
+        }
+
+        [[nodiscard]] bool empty() const noexcept
+        {
+            return dequeuePos_.load(std::memory_order_seq_cst) == enqueuePos_.load(std::memory_order_seq_cst);
+        }
+
+    private:
+        [[nodiscard]] static std::size_t roundUpToPowerOfTwo(std::size_t value) noexcept
+        {
+            std::size_t result = 1;
+            while (result < value) {
+                result <<= 1U;
+            }
+            return result;
+        }
+
+        template <bool Recycle, typename F>
+        [[nodiscard]] bool pop(F&& f) noexcept
+        {
+            auto pos = dequeuePos_.load(std::memory_order_relaxed);
+            while (true) {
+                auto& slot = slots_[pos & mask_];
+                const auto diff = static_cast<std::int64_t>(slot.sequence.load(std::memory_order_acquire) - (pos + 1));
+
+                if (diff == 0) {
+                    if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        //the slot stays ours until the sequence is bumped, so the record is used in place
+                        f(text(slot, pos & mask_), slot.info);
+                        if constexpr (Recycle) {
+                            recycle(slot);
+                        } else {
+                            slot.overflow = nullptr;
+                        }
+                        slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = dequeuePos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /// \brief Copy text into the block of slot or an overflow block. Returns false if there was no memory for it
+        [[nodiscard]] bool store(Slot& slot, std::size_t index, std::string_view text) noexcept
+        {
+            char* target = arena_.block(index);
+            if (text.size() > arena_.blockSize()) {
+                //the slot is already claimed and has to be published either way, so it is published empty
+                target = slot.overflow = arena_.allocate(text.size(), slot.overflow_class);
+                if (target == nullptr) {
+                    return false;
+                }
+            }
+            std::memcpy(target, text.data(), text.size());
+            return true;
+        }
+
+        [[nodiscard]] std::string_view text(const Slot& slot, std::size_t index) const noexcept
+        {
+            return std::string_view{slot.overflow != nullptr ? slot.overflow : arena_.block(index), slot.info.size};
+        }
+
+        void recycle(Slot& slot) noexcept
+        {
+            if (slot.overflow != nullptr) {
+                arena_.deallocate(slot.overflow, slot.overflow_class);
+                slot.overflow = nullptr;
+            }
+        }
+
+        const std::size_t mask_;
+        std::unique_ptr<Slot[]> slots_; //NOLINT(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+        RecordArena arena_;
+
+        //producers and consumers only share the slots, never the cache line of the other index
+        alignas(cache_line_size) std::atomic<std::uint64_t> enqueuePos_{0};
+        alignas(cache_line_size) std::atomic<std::uint64_t> dequeuePos_{0};
+    };
+
+} // namespace Logger::details
+
+#endif /* RECORDRING_H_ */
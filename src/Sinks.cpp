@@ -0,0 +1,501 @@
+/**
+*\file Sinks.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Registry of the outputs every record is written to
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+#include "Sinks.h"
+#include "Stats.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#if RAYCHELLOGGER_HAS_POSIX_IO
+    #include <unistd.h>
+#endif
+
+namespace Logger::details {
+
+    //std::cout may be redirected later on, but this buffer always ends up in the standard output
+    static std::streambuf* const stdoutBuf = std::cout.rdbuf();
+
+//We disable -Wsign-conversion here because std::string_view::size() returns an unsigned std::size_t
+//but std::ostream::write() takes a std::streamsize which is signed. We cannot do anything about that :(
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+
+    [[nodiscard]] static bool passes(const SinkOptions& options, LogLevel level) noexcept
+    {
+        return level >= options.min_level || level == LogLevel::fatal;
+    }
+
+    void writeRecords(std::string_view records, const RecordInfo* infos, std::size_t count) noexcept
+    {
+        //thread buffers can mix records of several channels, each run of one channel is written as a batch
+        std::size_t begin = 0;
+        std::size_t offset = 0;
+        while (begin < count) {
+            std::size_t end = begin;
+            std::size_t size = 0;
+            for (; end < count && infos[end].sinks == infos[begin].sinks; end++) {
+                size += infos[end].size;
+            }
+
+            infos[begin].sinks->write(records.substr(offset, size), infos + begin, end - begin);
+            offset += size;
+            begin = end;
+        }
+    }
+
+    void writeRecords(const std::string_view* records, const RecordInfo* infos, std::size_t count) noexcept
+    {
+        std::size_t begin = 0;
+        while (begin < count) {
+            std::size_t end = begin;
+            while (end < count && infos[end].sinks == infos[begin].sinks) {
+                end++;
+            }
+
+            infos[begin].sinks->write(records + begin, infos + begin, end - begin);
+            begin = end;
+        }
+    }
+
+    //writers share the sinks without locking the registry, so scratch space belongs to the writing thread
+    static thread_local std::string formatted; //output of a formatter
+    static thread_local std::vector<std::string_view> batchParts;
+
+    //sinks of the same or of different channels can share a stream buffer, so writes are serialized per buffer
+    static std::array<std::mutex, 16> streamLocks;
+
+    //how many sink lists the calling thread is writing to right now, see SinkRegistry::reclaim
+    static thread_local std::size_t readDepth{0};
+
+    [[nodiscard]] static std::mutex& streamLock(const std::ostream& os) noexcept
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(os.rdbuf()); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        return streamLocks[(address / alignof(std::max_align_t)) % streamLocks.size()];
+    }
+
+    SinkRegistry::SinkRegistry() : primaryStream_{bufferOutput(std::cout.rdbuf())}
+    {
+        auto list = std::make_unique<SinkList>();
+        list->push_back(Sink{primary_sink, SinkOptions{LogLevel::debug, true}, primaryStream_});
+        sinks_.store(list.release(), std::memory_order_release);
+    }
+
+    SinkRegistry::~SinkRegistry() noexcept
+    {
+        delete sinks_.load(std::memory_order_acquire);
+    }
+
+    void SinkRegistry::write(std::string_view records, const RecordInfo* infos, std::size_t count) noexcept
+    {
+        if (count == 0) {
+            return;
+        }
+
+        const auto [lowest, highest] = std::minmax_element(
+            infos, infos + count, [](const RecordInfo& a, const RecordInfo& b) { return a.level < b.level; });
+
+        const auto generation = beginRead();
+        const auto done = Finally{[this, generation]() noexcept { endRead(generation); }};
+
+        for (const auto& sink : *sinks_.load(std::memory_order_seq_cst)) {
+            //the common case: the records can be written exactly as they were formatted
+            if (sink.options.color && sink.options.formatter == nullptr && passes(sink.options, lowest->level)) {
+                emit(*sink.output, records, highest->level);
+                continue;
+            }
+
+            std::size_t offset = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                writeRecord(sink, records.substr(offset, infos[i].size), infos[i]);
+                offset += infos[i].size;
+            }
+        }
+    }
+
+    void SinkRegistry::write(const std::string_view* records, const RecordInfo* infos, std::size_t count) noexcept
+    {
+        if (count == 0) {
+            return;
+        }
+
+        const auto highest = std::max_element(infos, infos + count, [](const RecordInfo& a, const RecordInfo& b) {
+                                 return a.level < b.level;
+                             })->level;
+
+        const auto generation = beginRead();
+        const auto done = Finally{[this, generation]() noexcept { endRead(generation); }};
+
+        for (const auto& sink : *sinks_.load(std::memory_order_seq_cst)) {
+            auto& output = *sink.output;
+            const bool batched = output.file || writesToStdout(output);
+            if (sink.options.formatter != nullptr || output.mapped || output.network || !batched) {
+                for (std::size_t i = 0; i < count; i++) {
+                    writeRecord(sink, records[i], infos[i]);
+                }
+                continue;
+            }
+
+            batchParts.clear();
+            std::size_t size = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                if (passes(sink.options, infos[i].level)) {
+                    batchParts.push_back(sink.options.color ? records[i] : plainText(records[i], infos[i]));
+                    size += batchParts.back().size();
+                }
+            }
+            if (batchParts.empty()) {
+                continue;
+            }
+
+            bump(threadStats().bytes_written, size);
+            if (output.file) {
+                output.file->write(batchParts.data(), batchParts.size(), highest);
+            } else {
+#if RAYCHELLOGGER_HAS_POSIX_IO
+                //whatever went through the stream so far has to come first
+                const auto lock = lockCounted(streamLock(*output.stream));
+                output.stream->flush();
+                writeVectored(STDOUT_FILENO, {}, batchParts.data(), batchParts.size());
+#endif
+            }
+        }
+    }
+
+    void SinkRegistry::flush() noexcept
+    {
+        const auto generation = beginRead();
+        const auto done = Finally{[this, generation]() noexcept { endRead(generation); }};
+
+        for (const auto& sink : *sinks_.load(std::memory_order_seq_cst)) {
+            flush(*sink.output);
+        }
+    }
+
+    void SinkRegistry::setPrimaryStream(std::streambuf* buf) noexcept
+    {
+        //writers may still use the old stream, so the primary sink gets a new one instead of changing its buffer
+        std::shared_ptr<Output> output;
+        try {
+            output = bufferOutput(buf);
+        } catch (...) {
+            return; //out of memory, keep the current stream
+        }
+
+        reconfigure([this, &output](SinkList& list) {
+            find(list, primary_sink)->output = output;
+            primaryStream_ = output;
+            return true;
+        });
+    }
+
+    bool SinkRegistry::openPrimaryFile(const std::string& path, const FileSinkOptions& options)
+    {
+        auto output = fileOutput(path, options);
+        if (!output) {
+            return false;
+        }
+
+        return reconfigure([&output](SinkList& list) {
+            find(list, primary_sink)->output = output;
+            return true;
+        });
+    }
+
+    void SinkRegistry::closePrimaryFile() noexcept
+    {
+        reconfigure([this](SinkList& list) {
+            find(list, primary_sink)->output = primaryStream_;
+            return true;
+        });
+    }
+
+    SinkId SinkRegistry::add(std::ostream& os, const SinkOptions& options)
+    {
+        return add(options, streamOutput(os));
+    }
+
+    std::optional<SinkId> SinkRegistry::addFile(const std::string& path, const SinkOptions& options, const FileSinkOptions& file_options)
+    {
+        auto output = fileOutput(path, file_options);
+        if (!output) {
+            return std::nullopt;
+        }
+        return add(options, std::move(output));
+    }
+
+    std::optional<SinkId> SinkRegistry::addNetwork(
+        std::string host, std::uint16_t port, const SinkOptions& options, const NetworkSinkOptions& network_options)
+    {
+        auto output = std::make_shared<Output>();
+        output->network = std::make_unique<NetworkSink>();
+        if (!output->network->open(std::move(host), port, network_options)) {
+            return std::nullopt;
+        }
+        return add(options, std::move(output));
+    }
+
+    bool SinkRegistry::remove(SinkId id) noexcept
+    {
+        if (id == primary_sink) {
+            return false;
+        }
+
+        //once reconfigure returns, no other writer can reach the output anymore. Files are flushed and closed when it is
+        //destroyed. If this thread is writing to the sinks itself, that is delayed until a later change
+        std::shared_ptr<Output> removed;
+        reconfigure([id, &removed](SinkList& list) {
+            const auto it = std::find_if(list.begin(), list.end(), [id](const Sink& sink) { return sink.id == id; });
+            if (it == list.end()) {
+                return false;
+            }
+            removed = it->output;
+            list.erase(it);
+            return true;
+        });
+
+        if (!removed) {
+            return false;
+        }
+        flush(*removed);
+        return true;
+    }
+
+    bool SinkRegistry::setOptions(SinkId id, const SinkOptions& options) noexcept
+    {
+        return reconfigure([id, &options](SinkList& list) {
+            auto* sink = find(list, id);
+            if (sink == nullptr) {
+                return false;
+            }
+            sink->options = options;
+            return true;
+        });
+    }
+
+    void SinkRegistry::setColor(SinkId id, bool color) noexcept
+    {
+        reconfigure([id, color](SinkList& list) {
+            auto* sink = find(list, id);
+            if (sink == nullptr) {
+                return false;
+            }
+            sink->options.color = color;
+            return true;
+        });
+    }
+
+    SinkId SinkRegistry::add(const SinkOptions& options, std::shared_ptr<Output> output)
+    {
+        SinkId id{};
+        if (!reconfigure([&](SinkList& list) {
+                id = nextId_++;
+                list.push_back(Sink{id, options, output});
+                return true;
+            })) {
+            throw std::bad_alloc{};
+        }
+        return id;
+    }
+
+    std::size_t SinkRegistry::beginRead() const noexcept
+    {
+        readDepth++;
+        const auto generation = generation_.load(std::memory_order_seq_cst) & 1U;
+        readers_[generation].fetch_add(1, std::memory_order_seq_cst);
+        return generation;
+    }
+
+    void SinkRegistry::endRead(std::size_t generation) const noexcept
+    {
+        readers_[generation].fetch_sub(1, std::memory_order_seq_cst);
+        readDepth--;
+    }
+
+    template <typename F>
+    bool SinkRegistry::update(F&& change) noexcept
+    {
+        const auto* old_list = sinks_.load(std::memory_order_relaxed);
+        std::unique_ptr<SinkList> new_list;
+        try {
+            new_list = std::make_unique<SinkList>(*old_list);
+            retired_.reserve(retired_.size() + 1);
+            if (!change(*new_list)) {
+                return false;
+            }
+        } catch (...) {
+            return false; //out of memory, keep the current list
+        }
+
+        sinks_.store(new_list.release(), std::memory_order_seq_cst);
+        retired_.emplace_back(old_list);
+        return true;
+    }
+
+    template <typename F>
+    bool SinkRegistry::reconfigure(F&& change) noexcept
+    {
+        bool changed = false;
+        {
+            std::lock_guard lock{mtx_};
+            changed = update(std::forward<F>(change));
+        }
+        reclaim();
+        return changed;
+    }
+
+    void SinkRegistry::reclaim() noexcept
+    {
+        if (readDepth != 0) {
+            return; //would wait for itself
+        }
+
+        //mtx_ is not held while waiting, so writers may change the sinks from inside a sink in the meantime
+        std::lock_guard reclaim_lock{reclaimMtx_};
+        std::vector<std::unique_ptr<const SinkList>> retired;
+        {
+            std::lock_guard lock{mtx_};
+            retired.swap(retired_);
+        }
+        if (!retired.empty()) {
+            waitForReaders();
+        }
+        //the lists and every output only they pointed to are destroyed here
+    }
+
+    void SinkRegistry::waitForReaders() noexcept
+    {
+        //a writer that read the generation just before a switch may still count itself in the old counter and load the
+        //old list after that, so both counters have to be seen at zero once, each after switching away from it
+        for (int i = 0; i < 2; i++) {
+            const auto previous = generation_.fetch_add(1, std::memory_order_seq_cst) & 1U;
+            while (readers_[previous].load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    SinkRegistry::Sink* SinkRegistry::find(SinkList& list, SinkId id) noexcept
+    {
+        const auto it = std::find_if(list.begin(), list.end(), [id](const Sink& sink) { return sink.id == id; });
+        return it == list.end() ? nullptr : &*it;
+    }
+
+    std::shared_ptr<SinkRegistry::Output> SinkRegistry::streamOutput(std::ostream& os)
+    {
+        auto output = std::make_shared<Output>();
+        output->stream = &os;
+        return output;
+    }
+
+    std::shared_ptr<SinkRegistry::Output> SinkRegistry::bufferOutput(std::streambuf* buf)
+    {
+        auto output = std::make_shared<Output>();
+        output->ownStream = std::make_unique<std::ostream>(buf);
+        output->stream = output->ownStream.get();
+        return output;
+    }
+
+    std::shared_ptr<SinkRegistry::Output> SinkRegistry::fileOutput(const std::string& path, const FileSinkOptions& options)
+    {
+        auto output = std::make_shared<Output>();
+        if (options.memory_mapped) {
+            output->mapped = std::make_unique<MappedFileSink>();
+            return output->mapped->open(path, options) ? output : nullptr;
+        }
+
+        output->file = std::make_unique<FileSink>();
+        return output->file->open(path, options) ? output : nullptr;
+    }
+
+    bool SinkRegistry::writesToStdout([[maybe_unused]] const Output& output) noexcept
+    {
+#if RAYCHELLOGGER_HAS_POSIX_IO
+        const bool other_output = output.file || output.mapped || output.network;
+        return output.stream != nullptr && !other_output && output.stream->rdbuf() == stdoutBuf;
+#else
+        return false;
+#endif
+    }
+
+    void SinkRegistry::writeRecord(const Sink& sink, std::string_view record, const RecordInfo& info) noexcept
+    {
+        if (!passes(sink.options, info.level)) {
+            return;
+        }
+
+        const auto plain = plainText(record, info);
+
+        if (sink.options.formatter != nullptr) {
+            formatted.clear();
+            sink.options.formatter(formatted, info.level, plain);
+            emit(*sink.output, formatted, info.level);
+        } else {
+            emit(*sink.output, sink.options.color ? record : plain, info.level);
+        }
+    }
+
+    void SinkRegistry::emit(Output& output, std::string_view text, LogLevel level) noexcept
+    {
+        bump(threadStats().bytes_written, text.size());
+        if (output.mapped) {
+            output.mapped->write(text);
+        } else if (output.file) {
+            output.file->write(text, level);
+        } else if (output.network) {
+            output.network->write(text, level);
+        } else {
+            const auto lock = lockCounted(streamLock(*output.stream));
+            output.stream->write(text.data(), text.size());
+        }
+    }
+
+    void SinkRegistry::flush(Output& output) noexcept
+    {
+        if (output.mapped) {
+            const FlushTimer timer;
+            output.mapped->flush();
+        } else if (output.file) {
+            output.file->flush(); //counted by the file when it actually writes
+        } else if (output.network) {
+            output.network->flush();
+        } else {
+            const FlushTimer timer;
+            const std::lock_guard lock{streamLock(*output.stream)};
+            output.stream->flush();
+        }
+    }
+
+#pragma GCC diagnostic pop
+
+} // namespace Logger::details
@@ -0,0 +1,230 @@
+/**
+*\file Sinks.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Registry of the outputs every record is written to
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef SINKS_H_
+#define SINKS_H_
+
+#include "FileSink.h"
+#include "MappedFileSink.h"
+#include "NetworkSink.h"
+#include "RaychelLogger/Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Logger::details {
+
+    constexpr std::string_view reset_col = "\x1b[0m"; //only appended to records that start with a color sequence
+
+    /**
+    * \brief Layout of one finished record. Every record is formatted once with its color sequence, sinks without color
+    * write the part between the color sequence and the reset sequence
+    */
+    struct RecordInfo
+    {
+        std::uint32_t size; //including the color and reset sequences
+        std::uint32_t color_size;
+        LogLevel level;
+        SinkRegistry* sinks; //of the channel the record was logged to
+    };
+
+    /// \brief The part of a record between its color and reset sequences
+    [[nodiscard]] inline std::string_view plainText(std::string_view record, const RecordInfo& info) noexcept
+    {
+        const auto reset_size = info.color_size == 0 ? 0 : reset_col.size();
+        return record.substr(info.color_size, record.size() - std::min<std::size_t>(record.size(), info.color_size + reset_size));
+    }
+
+    /**
+    * \brief Write records to the sinks of their channels
+    * 
+    * \param records One or more complete records
+    * \param infos Layout of every record in records, in order
+    * \param count Number of records
+    */
+    void writeRecords(std::string_view records, const RecordInfo* infos, std::size_t count) noexcept;
+
+    /**
+    * \brief Write records that are not stored next to each other to the sinks of their channels
+    * 
+    * \param records Every record, in order
+    * \param infos Layout of every record
+    * \param count Number of records
+    */
+    void writeRecords(const std::string_view* records, const RecordInfo* infos, std::size_t count) noexcept;
+
+    /**
+    * \brief The sinks of one channel. Writers read an immutable snapshot of the sink list without locking, changes
+    * publish a new snapshot and free the old one once no writer uses it anymore. Files lock themselves and streams are
+    * locked per stream buffer, so writers only wait for each other while they write to the same output
+    */
+    class SinkRegistry
+    {
+    public:
+        SinkRegistry();
+
+        SinkRegistry(const SinkRegistry&) = delete;
+        SinkRegistry(SinkRegistry&&) = delete;
+
+        SinkRegistry& operator=(const SinkRegistry&) = delete;
+        SinkRegistry& operator=(SinkRegistry&&) = delete;
+
+        ~SinkRegistry() noexcept;
+
+        /**
+        * \brief Write records to every sink whose level they pass
+        * 
+        * \param records One or more complete records
+        * \param infos Layout of every record in records, in order
+        * \param count Number of records
+        */
+        void write(std::string_view records, const RecordInfo* infos, std::size_t count) noexcept;
+
+        /**
+        * \brief Write records that are not stored next to each other. Log files and the standard output receive the
+        * whole batch in a single vectored write where possible
+        * 
+        * \param records Every record, in order
+        * \param infos Layout of every record
+        * \param count Number of records
+        */
+        void write(const std::string_view* records, const RecordInfo* infos, std::size_t count) noexcept;
+
+        void flush() noexcept;
+
+        /// \brief Let the primary sink write to buf again instead of the log file
+        void setPrimaryStream(std::streambuf* buf) noexcept;
+
+        [[nodiscard]] bool openPrimaryFile(const std::string& path, const FileSinkOptions& options);
+
+        void closePrimaryFile() noexcept;
+
+        [[nodiscard]] SinkId add(std::ostream& os, const SinkOptions& options);
+
+        [[nodiscard]] std::optional<SinkId> addFile(const std::string& path, const SinkOptions& options, const FileSinkOptions& file_options);
+
+        [[nodiscard]] std::optional<SinkId> addNetwork(
+            std::string host, std::uint16_t port, const SinkOptions& options, const NetworkSinkOptions& network_options);
+
+        bool remove(SinkId id) noexcept;
+
+        bool setOptions(SinkId id, const SinkOptions& options) noexcept;
+
+        void setColor(SinkId id, bool color) noexcept;
+
+    private:
+        /// \brief Where a sink writes to. Shared by every snapshot the sink is in and destroyed with the last of them
+        struct Output
+        {
+            std::ostream* stream{nullptr}; //not owned. Only written to if no file or network sink is open
+            std::unique_ptr<std::ostream> ownStream; //of the primary sink, which gets a new one for every new buffer
+            std::unique_ptr<FileSink> file;
+            std::unique_ptr<MappedFileSink> mapped;
+            std::unique_ptr<NetworkSink> network;
+        };
+
+        struct Sink
+        {
+            SinkId id;
+            SinkOptions options;
+            std::shared_ptr<Output> output;
+        };
+
+        using SinkList = std::vector<Sink>;
+
+        /// \brief Announce a writer. Returns the generation to pass to endRead
+        [[nodiscard]] std::size_t beginRead() const noexcept;
+
+        void endRead(std::size_t generation) const noexcept;
+
+        /**
+        * \brief Publish a copy of the current list changed by change and retire the old one. Called with mtx_ held
+        * 
+        * \return false if change returned false or there was no memory for the copy
+        */
+        template <typename F>
+        bool update(F&& change) noexcept;
+
+        /// \brief update() with mtx_ held, then reclaim() without it
+        template <typename F>
+        bool reconfigure(F&& change) noexcept;
+
+        /**
+        * \brief Free the retired lists once no writer uses them anymore. A thread that is writing to sinks itself (e.g. a
+        * sink that adds or removes sinks) cannot wait for that, its lists are freed by a later change instead
+        */
+        void reclaim() noexcept;
+
+        /// \brief Wait until every writer that could still see a retired list is done. Called with reclaimMtx_ held
+        void waitForReaders() noexcept;
+
+        [[nodiscard]] static Sink* find(SinkList& list, SinkId id) noexcept;
+
+        [[nodiscard]] static std::shared_ptr<Output> streamOutput(std::ostream& os);
+
+        /// \brief Output with a stream of its own that writes to buf
+        [[nodiscard]] static std::shared_ptr<Output> bufferOutput(std::streambuf* buf);
+
+        /// \brief Open either a FileSink or a MappedFileSink, depending on options.memory_mapped
+        [[nodiscard]] static std::shared_ptr<Output> fileOutput(const std::string& path, const FileSinkOptions& options);
+
+        /// \brief True if output is a stream that writes to the standard output, which batches can bypass
+        [[nodiscard]] static bool writesToStdout(const Output& output) noexcept;
+
+        /// \brief Add a sink that writes to output. Throws std::bad_alloc if the sink list could not be copied
+        [[nodiscard]] SinkId add(const SinkOptions& options, std::shared_ptr<Output> output);
+
+        static void writeRecord(const Sink& sink, std::string_view record, const RecordInfo& info) noexcept;
+
+        static void emit(Output& output, std::string_view text, LogLevel level) noexcept;
+
+        static void flush(Output& output) noexcept;
+
+        std::mutex mtx_; //only taken to change the sinks, never while writing
+        std::atomic<const SinkList*> sinks_;
+        std::vector<std::unique_ptr<const SinkList>> retired_; //replaced lists that writers may still use
+        std::mutex reclaimMtx_;
+        std::shared_ptr<Output> primaryStream_; //what the primary sink writes to while no log file is open
+        SinkId nextId_{primary_sink + 1};
+
+        //writers count themselves in the counter of the current generation, see waitForReaders
+        mutable std::atomic<std::size_t> generation_{0};
+        mutable std::array<std::atomic<std::size_t>, 2> readers_{};
+    };
+
+} // namespace Logger::details
+
+#endif /* SINKS_H_ */
@@ -0,0 +1,191 @@
+/**
+*\file Stats.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Per-thread counters of what the logger itself does
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+#include "Stats.h"
+
+#include <algorithm>
+#include <new>
+#include <vector>
+
+namespace Logger::details {
+
+    class StatsRegistry
+    {
+    public:
+        /// \brief Returns false if there was no memory to register stats
+        [[nodiscard]] bool add(ThreadStats& stats) noexcept
+        {
+            std::lock_guard lock{mtx_};
+            try {
+                live_.push_back(&stats);
+            } catch (const std::bad_alloc&) {
+                return false;
+            }
+            return true;
+        }
+
+        void retire(ThreadStats& stats) noexcept
+        {
+            std::lock_guard lock{mtx_};
+            addCounters(retired_, stats);
+            live_.erase(std::remove(live_.begin(), live_.end(), &stats), live_.end());
+        }
+
+        void sum(LoggerStats& result) noexcept
+        {
+            ThreadStats total;
+
+            std::lock_guard lock{mtx_};
+            addCounters(total, retired_);
+            for (const auto* stats : live_) {
+                addCounters(total, *stats);
+            }
+
+            for (std::size_t i = 0; i < level_count; i++) {
+                result.emitted.at(i) = total.emitted.at(i).load(std::memory_order_relaxed);
+                result.filtered.at(i) = total.filtered.at(i).load(std::memory_order_relaxed);
+            }
+            result.bytes_written = total.bytes_written.load(std::memory_order_relaxed);
+            result.lock_contentions = total.lock_contentions.load(std::memory_order_relaxed);
+            result.lock_wait_time = std::chrono::nanoseconds{total.lock_wait_ns.load(std::memory_order_relaxed)};
+            result.flushes = total.flushes.load(std::memory_order_relaxed);
+            result.flush_time = std::chrono::nanoseconds{total.flush_ns.load(std::memory_order_relaxed)};
+            result.file_dropped = total.file_dropped.load(std::memory_order_relaxed);
+            result.file_errors = total.file_errors.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Counters of threads that have exited. Threads without counters of their own bump these directly, see usesSharedStats
+        [[nodiscard]] ThreadStats& retired() noexcept
+        {
+            return retired_;
+        }
+
+    private:
+        static void addCounters(ThreadStats& target, const ThreadStats& source) noexcept
+        {
+            //target may be the shared total, which threads without counters of their own bump without taking mtx_
+            const auto add = [](std::atomic<std::uint64_t>& to, const std::atomic<std::uint64_t>& from) {
+                to.fetch_add(from.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            };
+
+            for (std::size_t i = 0; i < level_count; i++) {
+                add(target.emitted.at(i), source.emitted.at(i));
+                add(target.filtered.at(i), source.filtered.at(i));
+            }
+            add(target.bytes_written, source.bytes_written);
+            add(target.lock_contentions, source.lock_contentions);
+            add(target.lock_wait_ns, source.lock_wait_ns);
+            add(target.flushes, source.flushes);
+            add(target.flush_ns, source.flush_ns);
+            add(target.file_dropped, source.file_dropped);
+            add(target.file_errors, source.file_errors);
+        }
+
+        std::mutex mtx_;
+        std::vector<ThreadStats*> live_;
+        ThreadStats retired_;
+    };
+
+    /// \brief Never destroyed, threads that exit during static destruction still retire their counters
+    [[nodiscard]] static StatsRegistry& statsRegistry()
+    {
+        static auto* registry = new StatsRegistry{}; //NOLINT(cppcoreguidelines-owning-memory)
+        return *registry;
+    }
+
+    //the holder has a destructor, so every access to it goes through a guard. The hot path only reads the plain pointer
+    static thread_local ThreadStats* localStatsPtr{nullptr};
+
+    class LocalStats
+    {
+    public:
+        LocalStats() noexcept : registered_{statsRegistry().add(stats_)}
+        {}
+
+        LocalStats(const LocalStats&) = delete;
+        LocalStats(LocalStats&&) = delete;
+
+        LocalStats& operator=(const LocalStats&) = delete;
+        LocalStats& operator=(LocalStats&&) = delete;
+
+        ~LocalStats() noexcept
+        {
+            localStatsPtr = nullptr;
+            usesSharedStats = true;
+            statsRegistry().retire(stats_);
+        }
+
+        [[nodiscard]] ThreadStats& get() noexcept
+        {
+            return stats_;
+        }
+
+        [[nodiscard]] bool registered() const noexcept
+        {
+            return registered_;
+        }
+
+    private:
+        ThreadStats stats_;
+        bool registered_;
+    };
+
+    [[nodiscard]] static ThreadStats& registerThread() noexcept
+    {
+        //records logged by destructors of other thread_locals after the holder is gone end up in the shared total
+        if (usesSharedStats) {
+            return statsRegistry().retired();
+        }
+
+        static thread_local LocalStats holder;
+        if (!holder.registered()) {
+            //stats() would never see counters that are not in the registry
+            usesSharedStats = true;
+            return statsRegistry().retired();
+        }
+        localStatsPtr = &holder.get();
+        return holder.get();
+    }
+
+    ThreadStats& threadStats() noexcept
+    {
+        auto* stats = localStatsPtr;
+        return stats != nullptr ? *stats : registerThread();
+    }
+
+    void sumThreadStats(LoggerStats& stats) noexcept
+    {
+        statsRegistry().sum(stats);
+    }
+
+    void countFiltered(LogLevel level) noexcept
+    {
+        bump(threadStats().filtered[static_cast<std::size_t>(level)]); //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+
+} // namespace Logger::details
@@ -0,0 +1,140 @@
+/**
+*\file Stats.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Per-thread counters of what the logger itself does
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef STATS_H_
+#define STATS_H_
+
+#include "RaychelLogger/Logger.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace Logger::details {
+
+    constexpr std::size_t level_count = static_cast<std::size_t>(LogLevel::log) + 1;
+
+    //data written by different threads is kept this far apart so it never shares a cache line
+    constexpr std::size_t cache_line_size = 64;
+
+    /**
+    * \brief Counters of one thread. Only that thread writes them, so they are bumped with a plain load and store. Atomic
+    * only so stats() can read them at the same time
+    */
+    struct ThreadStats
+    {
+        std::array<std::atomic<std::uint64_t>, level_count> emitted{};
+        std::array<std::atomic<std::uint64_t>, level_count> filtered{};
+        std::atomic<std::uint64_t> bytes_written{0};
+        std::atomic<std::uint64_t> lock_contentions{0};
+        std::atomic<std::uint64_t> lock_wait_ns{0};
+        std::atomic<std::uint64_t> flushes{0};
+        std::atomic<std::uint64_t> flush_ns{0};
+        std::atomic<std::uint64_t> file_dropped{0};
+        std::atomic<std::uint64_t> file_errors{0};
+    };
+
+    /**
+    * \brief Get the counters of the calling thread. They are registered on first use and folded into a global total when the thread exits
+    */
+    [[nodiscard]] ThreadStats& threadStats() noexcept;
+
+    /**
+    * \brief Add the counters of every thread, including the ones that have exited, to stats
+    */
+    void sumThreadStats(LoggerStats& stats) noexcept;
+
+    /**
+    * \brief Set once the calling thread has no counters of its own, either because they were already folded into the total
+    * of exited threads or because they could not be registered. threadStats() then returns that total, which several
+    * threads may bump at the same time
+    */
+    inline thread_local bool usesSharedStats{false};
+
+    inline void bump(std::atomic<std::uint64_t>& counter, std::uint64_t amount = 1) noexcept
+    {
+        if (usesSharedStats) {
+            counter.fetch_add(amount, std::memory_order_relaxed);
+        } else {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] inline std::uint64_t nanosecondsSince(std::chrono::steady_clock::time_point start) noexcept
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    /**
+    * \brief Lock mutex and count the wait if it was already locked. Uncontended locks cost one try_lock
+    */
+    template <typename Mutex>
+    [[nodiscard]] std::unique_lock<Mutex> lockCounted(Mutex& mutex) noexcept
+    {
+        std::unique_lock lock{mutex, std::try_to_lock};
+        if (!lock.owns_lock()) {
+            const auto start = std::chrono::steady_clock::now();
+            lock.lock();
+
+            auto& stats = threadStats();
+            bump(stats.lock_contentions);
+            bump(stats.lock_wait_ns, nanosecondsSince(start));
+        }
+        return lock;
+    }
+
+    /**
+    * \brief Counts one flush and the time until it goes out of scope
+    */
+    class FlushTimer
+    {
+    public:
+        FlushTimer() noexcept = default;
+
+        FlushTimer(const FlushTimer&) = delete;
+        FlushTimer(FlushTimer&&) = delete;
+
+        FlushTimer& operator=(const FlushTimer&) = delete;
+        FlushTimer& operator=(FlushTimer&&) = delete;
+
+        ~FlushTimer() noexcept
+        {
+            auto& stats = threadStats();
+            bump(stats.flushes);
+            bump(stats.flush_ns, nanosecondsSince(start_));
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start_{std::chrono::steady_clock::now()};
+    };
+
+} // namespace Logger::details
+
+#endif /* STATS_H_ */
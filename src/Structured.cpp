@@ -0,0 +1,257 @@
+/**
+*\file Structured.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Encoding of logfmt and json records and their key-value fields
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+#include "Structured.h"
+#include "Timestamp.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace Logger::details {
+
+    [[nodiscard]] static std::size_t escapedSize(char c) noexcept
+    {
+        switch (c) {
+            case '"':
+            case '\\':
+            case '\n':
+            case '\r':
+            case '\t':
+                return 2;
+            default:
+                return static_cast<unsigned char>(c) < 0x20 ? 6 : 1;
+        }
+    }
+
+    /// \brief Write the escaped form of c to dest, which has room for escapedSize(c) characters
+    static void writeEscaped(char* dest, char c) noexcept
+    {
+        constexpr std::string_view hex_digits = "0123456789abcdef";
+
+        //NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        switch (c) {
+            case '"':
+            case '\\':
+                dest[0] = '\\';
+                dest[1] = c;
+                return;
+            case '\n':
+                dest[0] = '\\';
+                dest[1] = 'n';
+                return;
+            case '\r':
+                dest[0] = '\\';
+                dest[1] = 'r';
+                return;
+            case '\t':
+                dest[0] = '\\';
+                dest[1] = 't';
+                return;
+            default:
+                break;
+        }
+
+        const auto code = static_cast<unsigned char>(c);
+        if (code < 0x20) {
+            std::memcpy(dest, "\\u00", 4);
+            dest[4] = hex_digits[code >> 4U];
+            dest[5] = hex_digits[code & 0xfU];
+        } else {
+            dest[0] = c;
+        }
+        //NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    /// \brief Same rules as go-logfmt: values with spaces, control characters, '=' or '"' have to be quoted
+    [[nodiscard]] static bool needsQuotes(char c) noexcept
+    {
+        return static_cast<unsigned char>(c) <= ' ' || c == '=' || c == '"';
+    }
+
+    static void appendEscaped(std::string& buffer, std::string_view text) noexcept
+    {
+        std::array<char, 6> escaped{};
+        for (const char c : text) {
+            const auto size = escapedSize(c);
+            if (size == 1) {
+                buffer.push_back(c);
+            } else {
+                writeEscaped(escaped.data(), c);
+                buffer.append(escaped.data(), size);
+            }
+        }
+    }
+
+    /**
+    * \brief Escape and quote everything in buffer behind start without a second buffer. Does nothing if always is false
+    * and the text is a valid logfmt value without quotes
+    */
+    static void quoteInPlace(std::string& buffer, std::size_t start, bool always) noexcept
+    {
+        const auto text_end = buffer.size();
+
+        std::size_t quoted_size = 2;
+        bool quote = always || text_end == start;
+        for (auto i = start; i < text_end; i++) {
+            quoted_size += escapedSize(buffer[i]);
+            quote = quote || needsQuotes(buffer[i]);
+        }
+        if (!quote) {
+            return;
+        }
+
+        buffer.resize(start + quoted_size);
+
+        //going backwards, every character is read before the escaped text behind it can overwrite it
+        auto out = buffer.size() - 1;
+        buffer[out] = '"';
+        for (auto in = text_end; in > start;) {
+            const char c = buffer[--in];
+            out -= escapedSize(c);
+            writeEscaped(&buffer[out], c);
+        }
+        buffer[start] = '"';
+    }
+
+    static void appendKey(std::string& buffer, std::string_view key, RecordFormat format, bool first) noexcept
+    {
+        if (format == RecordFormat::json) {
+            if (!first) {
+                buffer.push_back(',');
+            }
+            buffer.push_back('"');
+            appendEscaped(buffer, key);
+            buffer.append("\":");
+        } else {
+            if (!first) {
+                buffer.push_back(' ');
+            }
+            buffer.append(key).push_back('=');
+        }
+    }
+
+    static void appendValue(std::string& buffer, FieldKind kind, std::string_view value, RecordFormat format) noexcept
+    {
+        switch (kind) {
+            case FieldKind::boolean:
+                buffer.append(value == "1" || value == "true" ? "true" : "false");
+                return;
+            case FieldKind::number:
+                buffer.append(value);
+                return;
+            case FieldKind::string:
+                break;
+        }
+
+        if (format == RecordFormat::json) {
+            buffer.push_back('"');
+            appendEscaped(buffer, value);
+            buffer.push_back('"');
+        } else {
+            const auto start = buffer.size();
+            buffer.append(value);
+            quoteInPlace(buffer, start, false);
+        }
+    }
+
+    [[nodiscard]] static std::string_view readFieldText(std::string_view fields, std::size_t& offset) noexcept
+    {
+        std::uint32_t size{};
+        std::memcpy(&size, fields.data() + offset, sizeof(size)); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto text = fields.substr(offset + sizeof(size), size);
+        offset += sizeof(size) + size;
+        return text;
+    }
+
+    void beginStructuredRecord(
+        std::string& buffer, RecordFormat format, RecordTimestamp timestamp, std::string_view label) noexcept
+    {
+        if (format == RecordFormat::json) {
+            buffer.push_back('{');
+        }
+
+        bool first = true;
+
+        //the timestamp is formatted like in text records and moved behind its key
+        const auto time_start = buffer.size();
+        appendTimestamp(buffer, timestamp);
+        if (buffer.size() != time_start) {
+            std::array<char, 64> time_text{};
+            const auto time_size = std::min(buffer.size() - time_start - 1, time_text.size()); //without the trailing space
+            std::memcpy(time_text.data(), buffer.data() + time_start, time_size); //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            buffer.resize(time_start);
+
+            const std::string_view time{time_text.data(), time_size};
+            const bool raw = time.find_first_not_of("0123456789") == std::string_view::npos;
+            appendKey(buffer, "time", format, first);
+            appendValue(buffer, raw ? FieldKind::number : FieldKind::string, time, format);
+            first = false;
+        }
+
+        if (!label.empty()) {
+            appendKey(buffer, "level", format, first);
+            appendValue(buffer, FieldKind::string, label, format);
+            first = false;
+        }
+
+        appendKey(buffer, "msg", format, first);
+    }
+
+    void finishStructuredRecord(
+        std::string& buffer, std::size_t message_start, std::string_view fields, RecordFormat format) noexcept
+    {
+        //text records keep their line breaks behind the fields, logfmt and json records are always exactly one line
+        std::size_t line_breaks = 0;
+        while (buffer.size() > message_start && buffer.back() == '\n') {
+            buffer.pop_back();
+            line_breaks++;
+        }
+
+        if (format != RecordFormat::text) {
+            quoteInPlace(buffer, message_start, format == RecordFormat::json);
+            line_breaks = 1;
+        }
+
+        std::size_t offset = 0;
+        while (offset < fields.size()) {
+            const auto kind = static_cast<FieldKind>(fields[offset++]);
+            const auto key = readFieldText(fields, offset);
+            const auto value = readFieldText(fields, offset);
+
+            appendKey(buffer, key, format, false);
+            appendValue(buffer, kind, value, format);
+        }
+
+        if (format == RecordFormat::json) {
+            buffer.push_back('}');
+        }
+        buffer.append(line_breaks, '\n');
+    }
+
+} // namespace Logger::details
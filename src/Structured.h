@@ -0,0 +1,58 @@
+/**
+*\file Structured.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Encoding of logfmt and json records and their key-value fields
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef STRUCTURED_H_
+#define STRUCTURED_H_
+
+#include "RaychelLogger/Logger.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Logger::details {
+
+    /**
+    * \brief Append the time, level and msg keys of a logfmt or json record. The message is appended behind them
+    * 
+    * \param label Label of the level. Empty if the record has no label
+    */
+    void
+    beginStructuredRecord(std::string& buffer, RecordFormat format, RecordTimestamp timestamp, std::string_view label) noexcept;
+
+    /**
+    * \brief Escape the message of a record and append its fields. Not needed for text records without fields
+    * 
+    * \param message_start Where the message starts in buffer. The record ends at the end of buffer
+    * \param fields The fields of the record in structuredFields()
+    */
+    void finishStructuredRecord(
+        std::string& buffer, std::size_t message_start, std::string_view fields, RecordFormat format) noexcept;
+
+} // namespace Logger::details
+
+#endif /* STRUCTURED_H_ */
@@ -0,0 +1,131 @@
+/**
+*\file Timestamp.cpp
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Formatting of record timestamps
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+
+#include "Timestamp.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+
+namespace Logger::details {
+
+    static std::atomic<TimestampFormat> timestampFormat{TimestampFormat::none};
+
+    constexpr std::size_t date_time_size = 19; //YYYY-MM-DD HH:MM:SS
+
+    /// \brief Date and time of the last second a thread logged in
+    struct DateTimeCache
+    {
+        std::int64_t second{-1};
+        std::array<char, date_time_size + 1> text{};
+    };
+
+    static thread_local DateTimeCache dateTimeCache;
+
+    static void appendDigits(std::string& buffer, std::uint64_t value, std::size_t digits) noexcept
+    {
+        std::array<char, 20> chars{};
+        for (std::size_t i = digits; i > 0; i--) {
+            chars[i - 1] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        buffer.append(chars.data(), digits);
+    }
+
+    static void updateDateTime(DateTimeCache& cache, std::int64_t second) noexcept
+    {
+        const auto time = static_cast<std::time_t>(second);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        std::strftime(cache.text.data(), cache.text.size(), "%Y-%m-%d %H:%M:%S", &local);
+        cache.second = second;
+    }
+
+    RecordTimestamp timestampNow() noexcept
+    {
+        const auto format = timestampFormat.load(std::memory_order_relaxed);
+        if (format == TimestampFormat::none) {
+            return {};
+        }
+
+        const auto since_epoch = format == TimestampFormat::raw ? std::chrono::steady_clock::now().time_since_epoch()
+                                                                : std::chrono::system_clock::now().time_since_epoch();
+        return {static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count()), format};
+    }
+
+    void appendTimestamp(std::string& buffer, RecordTimestamp record_time) noexcept
+    {
+        constexpr std::uint64_t nanoseconds_per_second = 1'000'000'000;
+
+        //the format the timestamp was taken in, the current one may not fit the clock it came from
+        const auto format = record_time.format;
+        const auto timestamp = record_time.nanoseconds;
+        switch (format) {
+            case TimestampFormat::none:
+                return;
+            case TimestampFormat::raw:
+                appendInteger(buffer, timestamp);
+                buffer.push_back(' ');
+                return;
+            default:
+                break;
+        }
+
+        const auto second = static_cast<std::int64_t>(timestamp / nanoseconds_per_second);
+        auto& cache = dateTimeCache;
+        if (second != cache.second) {
+            updateDateTime(cache, second);
+        }
+        buffer.append(cache.text.data(), date_time_size);
+
+        const auto fraction = timestamp % nanoseconds_per_second;
+        if (format == TimestampFormat::milliseconds) {
+            buffer.push_back('.');
+            appendDigits(buffer, fraction / 1'000'000, 3);
+        } else if (format == TimestampFormat::microseconds) {
+            buffer.push_back('.');
+            appendDigits(buffer, fraction / 1'000, 6);
+        }
+        buffer.push_back(' ');
+    }
+
+} // namespace Logger::details
+
+namespace Logger {
+
+    void setTimestampFormat(TimestampFormat format) noexcept
+    {
+        details::timestampFormat.store(format, std::memory_order_relaxed);
+    }
+
+} // namespace Logger
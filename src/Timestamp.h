@@ -0,0 +1,46 @@
+/**
+*\file Timestamp.h
+*\author weckyy702 (weckyy702@gmail.com)
+*\brief Formatting of record timestamps
+*\date 2026-10-14
+*
+*MIT License
+*Copyright (c) [2021] [Weckyy702 (weckyy702@gmail.com | https://github.com/Weckyy702)]
+*Permission is hereby granted, free of charge, to any person obtaining a copy
+*of this software and associated documentation files (the "Software"), to deal
+*in the Software without restriction, including without limitation the rights
+*to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*copies of the Software, and to permit persons to whom the Software is
+*furnished to do so, subject to the following conditions:
+*
+*The above copyright notice and this permission notice shall be included in all
+*copies or substantial portions of the Software.
+*
+*THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+*LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+*OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+*SOFTWARE.
+*
+*/
+#ifndef TIMESTAMP_H_
+#define TIMESTAMP_H_
+
+#include "RaychelLogger/Logger.h"
+
+#include <cstdint>
+#include <string>
+
+namespace Logger::details {
+
+    /**
+    * \brief Append a timestamp taken by timestampNow() and a space to buffer, in the format it was taken in. Does nothing
+    * if timestamps were disabled at that time
+    */
+    void appendTimestamp(std::string& buffer, RecordTimestamp timestamp) noexcept;
+
+} // namespace Logger::details
+
+#endif /* TIMESTAMP_H_ */
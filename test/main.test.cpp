@@ -1,7 +1,101 @@
+#include "RaychelLogger/Channel.h"
+#include "RaychelLogger/Latency.h"
 #include "RaychelLogger/Logger.h"
+#include "RaychelLogger/RateLimit.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if __has_include(<sys/socket.h>)
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #define TEST_HAS_SOCKETS 1
+#else
+    #define TEST_HAS_SOCKETS 0
+#endif
+
+//set by CMake, so the log files end up in the build directory
+#ifndef TEST_LOG_DIR
+    #define TEST_LOG_DIR "test_logs"
+#endif
 
 using namespace Logger;
 
+static int failures = 0;
+
+//does not stop the test, so one run reports every broken check
+#define CHECK(condition)                                                                                                         \
+    do {                                                                                                                         \
+        if (!(condition)) {                                                                                                      \
+            std::cerr << __FILE__ << ':' << __LINE__ << ": check failed: " #condition "\n";                                      \
+            failures++;                                                                                                          \
+        }                                                                                                                        \
+    } while (false)
+
+/// \brief Run body with the primary sink writing into a string, echo the string to std::cout and return it
+template <typename F>
+static std::string capture(F&& body)
+{
+    std::ostringstream out;
+    setOutStream(out);
+    body();
+    flush();
+    setOutStream(std::cout);
+    std::cout << out.str();
+    return out.str();
+}
+
+/// \brief The number behind every occurrence of marker in text, in order
+static std::vector<int> numbersAfter(std::string_view text, std::string_view marker)
+{
+    std::vector<int> numbers;
+    for (auto pos = text.find(marker); pos != std::string_view::npos; pos = text.find(marker, pos + 1)) {
+        numbers.push_back(std::stoi(std::string{text.substr(pos + marker.size(), 12)}));
+    }
+    return numbers;
+}
+
+/// \brief Check if numbers is first, first + 1, ... first + count - 1
+static bool isSequence(const std::vector<int>& numbers, int first, int count)
+{
+    if (numbers.size() != static_cast<std::size_t>(count)) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (numbers[static_cast<std::size_t>(i)] != first + i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::size_t occurrences(std::string_view text, std::string_view marker)
+{
+    std::size_t count = 0;
+    for (auto pos = text.find(marker); pos != std::string_view::npos; pos = text.find(marker, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+static std::string readFile(const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
 struct Streamable
 {};
 
@@ -13,8 +107,23 @@ std::ostream& operator<<(std::ostream& os, const Streamable& /*unused*/)
 struct NonStreamable
 {};
 
+struct Handle
+{
+    int id;
+};
+
+template <>
+struct Logger::formatter<Handle>
+{
+    static void format(std::string& out, const Handle& handle) noexcept
+    {
+        out.append("Handle #").append(std::to_string(handle.id));
+    }
+};
+
 int main(int /*unused*/, const char** /*unused*/)
 {
+    installCrashHandler();
     setMinimumLogLevel(LogLevel::debug);
 
     debug("Debug level\n");
@@ -46,6 +155,10 @@ int main(int /*unused*/, const char** /*unused*/)
     info(&cv_n, '\n');
     info(&ref_cv_n, '\n');
 
+    info(Handle{7}, ' ', kv("handle", Handle{8}), '\n');
+    info(RAYCHELLOGGER_FMT("req {} took {}ms, {{braces}} stay\n"), 17, 2.5);
+    info(RAYCHELLOGGER_FMT("no slots\n"));
+
     const char* bad_style_string = "const char*";
     char worse_style_string[] = "char[]";
     char* worst_style_string = "char*"; //Actually not allowed since ISO C++11
@@ -54,5 +167,264 @@ int main(int /*unused*/, const char** /*unused*/)
     info(worse_style_string, '\n');
     info(worst_style_string, '\n');
 
+    info("pi is about ", 3.14159265, ", a third is about ", 1.0F / 3.0F, '\n');
+    info(std::string{"std::string"}, ' ', std::string_view{"std::string_view"}, ' ', true, '\n');
+
+    setMinimumLogLevel(LogLevel::info);
+    int evaluations = 0;
+    RAYCHELLOGGER_DEBUG("this is never evaluated ", ++evaluations, '\n');
+    RAYCHELLOGGER_INFO("lazy arguments were evaluated ", evaluations, " times before this message\n");
+    CHECK(evaluations == 0);
+    int level_evaluations = 0;
+    const auto leveled = [&level_evaluations] {
+        level_evaluations++;
+        return LogLevel::info;
+    };
+    RAYCHELLOGGER_LOG(leveled(), "the level of a record is evaluated once\n");
+    RAYCHELLOGGER_LOG_COLLAPSED(leveled(), std::chrono::seconds{1}, "even by the throttled macros\n");
+    CHECK(level_evaluations == 2);
+    setMinimumLogLevel(LogLevel::debug);
+
+    const auto async_output = capture([] {
+        enableAsync(16, OverflowPolicy::drop_oldest);
+        for (int i = 0; i < 32; i++) {
+            info("async record #", i, '\n');
+        }
+        disableAsync();
+    });
+    info("dropped ", droppedRecords(), " records\n");
+    {
+        //the writer may take records out of the queue while it fills up, so at most 16 of them are dropped. The newest are kept
+        const auto kept = numbersAfter(async_output, "async record #");
+        CHECK(kept.size() + droppedRecords() == 32);
+        CHECK(kept.size() >= 16);
+        CHECK(std::adjacent_find(kept.begin(), kept.end(), std::greater_equal<>{}) == kept.end());
+        CHECK(!kept.empty() && kept.back() == 31);
+    }
+
+    const auto buffered_output = capture([] {
+        enableThreadBuffering(256);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; t++) {
+            threads.emplace_back([t] {
+                for (int i = 0; i < 8; i++) {
+                    info("thread ", t, " buffered record #", i, '\n');
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        disableThreadBuffering();
+    });
+    for (int t = 0; t < 4; t++) {
+        const auto marker = "thread " + std::to_string(t) + " buffered record #";
+        CHECK(isSequence(numbersAfter(buffered_output, marker), 0, 8));
+    }
+
+    const auto binary_output = capture([] {
+        enableBinaryLogging(4096);
+        for (int i = 0; i < 256; i++) {
+            info("binary record #", i, " at ", &i, ' ', i / 3.0, ' ', std::string{"copied"}, '\n');
+        }
+        flush();
+        warn("binary records are formatted on a background thread\n");
+        disableBinaryLogging();
+    });
+    CHECK(isSequence(numbersAfter(binary_output, "binary record #"), 0, 256));
+    CHECK(occurrences(binary_output, " copied\n") == 256);
+    CHECK(stats().binary_dropped == 0);
+
+    const auto timer = startTimer();
+    startTimer("labeled timer");
+    logDuration<std::chrono::microseconds>(LogLevel::info, timer, "handle timer took ");
+    logDuration<std::chrono::microseconds>("labeled timer");
+
+    auto& loop_latency = latencyHistogram("loop body");
+    for (int i = 0; i < 1000; i++) {
+        const auto scope = scopedTimer(loop_latency);
+        [[maybe_unused]] volatile int work = i * i;
+    }
+    logLatencyStats(LogLevel::info);
+
+    {
+        std::ostringstream errors;
+        const auto errors_only = addSink(errors, SinkOptions{LogLevel::error, true});
+        info("this only goes to the primary sink\n");
+        error("this goes to the error sink as well\n");
+        flush();
+        removeSink(errors_only);
+        std::cerr << errors.str();
+        CHECK(occurrences(errors.str(), "primary sink") == 0);
+        CHECK(occurrences(errors.str(), "error sink") == 1);
+    }
+
+    setLogLabel(LogLevel::warn, "WARN");
+    setLogColor(LogLevel::warn, "\x1b[35m");
+    warn("labels and colors can be changed while other threads log\n");
+    setLogLabel(LogLevel::warn, "WARNING");
+    setLogColor(LogLevel::warn, "\x1b[33m");
+
+    auto& network = channel("network");
+    CHECK(&channel("network") == &network);
+    CHECK(&channel("default") == &defaultChannel());
+    network.setMinimumLogLevel(LogLevel::debug);
+    setMinimumLogLevel(LogLevel::warn);
+    network.debug("only the network channel logs debug records\n");
+    CHECK(occurrences(capture([] { debug("this is never logged\n"); }), "never logged") == 0);
+    RAYCHELLOGGER_LOG_TO(network, LogLevel::info, "lazy record on channel ", network.name(), '\n');
+    setMinimumLogLevel(LogLevel::debug);
+
+    setTimestampFormat(TimestampFormat::microseconds);
+    info("records can carry a timestamp\n");
+    info("which is only formatted once per second\n");
+    setTimestampFormat(TimestampFormat::raw);
+    info("or the raw steady clock\n");
+    setTimestampFormat(TimestampFormat::none);
+
+    const auto throttled_output = capture([] {
+        for (int i = 0; i < 1000; i++) {
+            RAYCHELLOGGER_LOG_EVERY_N(LogLevel::info, 250, "every 250th record, this is #", i, '\n');
+            RAYCHELLOGGER_LOG_FIRST_N(LogLevel::info, 2, "first two records, this is #", i, '\n');
+            RAYCHELLOGGER_LOG_RATE_LIMITED(
+                LogLevel::info, 3, std::chrono::seconds{1}, "three records per second, this is #", i, '\n');
+            RAYCHELLOGGER_LOG_RATE_LIMITED(
+                LogLevel::info, 0, std::chrono::milliseconds{1}, "never rate limited in, this is #", i, '\n');
+        }
+    });
+    CHECK(numbersAfter(throttled_output, "every 250th record, this is #") == (std::vector{0, 250, 500, 750}));
+    CHECK(isSequence(numbersAfter(throttled_output, "first two records, this is #"), 0, 2));
+    CHECK(occurrences(throttled_output, "never rate limited in") == 0);
+    {
+        //the second may end in the middle of the loop
+        const auto rate_limited = numbersAfter(throttled_output, "three records per second, this is #").size();
+        CHECK(rate_limited >= 1 && rate_limited <= 6);
+    }
+    const auto collapsed_output = capture([] {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 1000; j++) {
+                RAYCHELLOGGER_LOG_COLLAPSED(LogLevel::warn, std::chrono::milliseconds{10}, "connect failed\n");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+    });
+    CHECK(occurrences(collapsed_output, "connect failed") >= 3);
+    CHECK(occurrences(collapsed_output, "previous message repeated ") >= 1);
+
+    setSampleRate(LogLevel::debug, 100);
+    for (int i = 0; i < 1000; i++) {
+        RAYCHELLOGGER_DEBUG("about 1 in 100 debug records, this is #", i, '\n');
+        RAYCHELLOGGER_LOG_SAMPLED(LogLevel::info, 500, "about 1 in 500 records of this site, this is #", i, '\n');
+    }
+    setSampleRate(LogLevel::debug, 1);
+
+    const auto trace_output = capture([] {
+        setMinimumLogLevel(LogLevel::warn);
+        enableTrace(1234);
+        {
+            const TraceScope trace{1234};
+            debug("every record of trace 1234 is logged\n");
+        }
+        debug("this is never logged either\n");
+        disableTrace(1234);
+        setMinimumLogLevel(LogLevel::debug);
+    });
+    CHECK(occurrences(trace_output, "every record of trace 1234 is logged") == 1);
+    CHECK(occurrences(trace_output, "never logged") == 0);
+
+    FileSinkOptions file_options;
+    file_options.buffer_size = 64 * 1024;
+    file_options.flush.interval = std::chrono::milliseconds{50};
+    initLogFile(TEST_LOG_DIR, "Test.log", file_options);
+    info("this goes into test_logs/Test.log\n");
+    error("and this is flushed right away\n");
+    flush();
+    dumpLogFile();
+    {
+        const auto log_file = readFile(TEST_LOG_DIR "/Test.log");
+        CHECK(occurrences(log_file, "this goes into test_logs/Test.log") == 1);
+        CHECK(occurrences(log_file, "and this is flushed right away") == 1);
+    }
+    enableColor();
+
+    info("request done", kv("id", 42), kv("ms", 3.5), kv("path", "/index.html"), kv("ok", true), '\n');
+    setRecordFormat(RecordFormat::logfmt);
+    warn("slow \"request\"", kv("user", "jane doe"), kv("ms", 1200), '\n');
+    setRecordFormat(RecordFormat::json);
+    error("request failed\n", kv("id", 43), kv("reason", "timeout\tafter 5s"), kv("retry", false));
+    enableBinaryLogging();
+    info("binary ", kv("id", 44), kv("ratio", 0.25));
+    info(RAYCHELLOGGER_FMT("binary {} of {}"), 1, "two", kv("id", 45));
+    disableBinaryLogging();
+    setRecordFormat(RecordFormat::text);
+
+    FileSinkOptions mapped_options;
+    mapped_options.memory_mapped = true;
+    mapped_options.mapped_size = 4096;
+    mapped_options.rotation.max_files = 2;
+    if (const auto mapped = addFileSink(TEST_LOG_DIR, "Mapped.log", {}, mapped_options); mapped) {
+        for (int i = 0; i < 200; i++) {
+            info("record #", i, " goes into a memory mapped file\n");
+        }
+        removeSink(*mapped);
+
+        //three files of 4096 bytes are enough for all of them, the oldest is Mapped.log.2
+        std::string mapped_files;
+        for (const auto* name : {"/Mapped.log.2", "/Mapped.log.1", "/Mapped.log"}) {
+            mapped_files += readFile(std::string{TEST_LOG_DIR} + name);
+        }
+        CHECK(isSequence(numbersAfter(mapped_files, "record #"), 0, 200));
+        CHECK(stats().file_dropped == 0);
+    } else {
+        CHECK(!"the memory mapped file could not be created");
+    }
+
+#if TEST_HAS_SOCKETS
+    //a UDP socket on a free local port stands in for the syslog collector
+    const int collector_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in collector_address{};
+    collector_address.sin_family = AF_INET;
+    collector_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_size = sizeof(collector_address);
+    auto* const address = reinterpret_cast<sockaddr*>(&collector_address); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (collector_fd >= 0 && ::bind(collector_fd, address, address_size) == 0 &&
+        ::getsockname(collector_fd, address, &address_size) == 0) {
+        NetworkSinkOptions network_options;
+        network_options.syslog = true;
+        network_options.app_name = "alsdkjfa";
+        network_options.close_timeout = std::chrono::milliseconds{100};
+        const auto port = ntohs(collector_address.sin_port);
+        if (const auto collector = addNetworkSink("127.0.0.1", port, {}, network_options); collector) {
+            warn("this is also sent to a local syslog collector\n");
+            removeSink(*collector);
+
+            //removing the sink waits until the buffered records are sent
+            std::array<char, 1024> datagram{};
+            const auto received = ::recv(collector_fd, datagram.data(), datagram.size(), MSG_DONTWAIT);
+            const std::string_view message{datagram.data(), received > 0 ? static_cast<std::size_t>(received) : 0};
+            CHECK(message.substr(0, 4) == "<12>");
+            CHECK(occurrences(message, " alsdkjfa ") == 1);
+            CHECK(occurrences(message, "this is also sent to a local syslog collector") == 1);
+            CHECK(stats().network_dropped == 0);
+        } else {
+            CHECK(!"the network sink could not be created");
+        }
+    }
+    if (collector_fd >= 0) {
+        ::close(collector_fd);
+    }
+#endif
+
+    const auto counters = stats();
+    info("emitted ", counters.emitted[static_cast<std::size_t>(LogLevel::info)], " INFO records, filtered ",
+         counters.filtered[static_cast<std::size_t>(LogLevel::debug)], " DEBUG records, wrote ", counters.bytes_written, " bytes in ",
+         counters.flushes, " flushes\n");
+    CHECK(counters.emitted[static_cast<std::size_t>(LogLevel::info)] > 0);
+    CHECK(counters.bytes_written > 0);
+
+    if (failures != 0) {
+        std::cerr << failures << " checks failed\n";
+        return 1;
+    }
     return 0;
 }
\ No newline at end of file